@@ -0,0 +1,44 @@
+// Replaces the global operator new / delete so benchmarks can report allocations per iteration.
+//
+// Kept in its own translation unit: with the malloc/free bodies visible where containers call
+// new and delete, GCC inlines them and reports -Wmismatched-new-delete on every call site.
+
+#include "allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+std::atomic<std::size_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc requires a size that is a multiple of the alignment.
+    std::size_t rounded = (size + align - 1) / align * align;
+    if (void* p = std::aligned_alloc(align, rounded ? rounded : align))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,11 @@
+#ifndef TS_BENCHMARK_ALLOCATION_COUNTER_H
+#define TS_BENCHMARK_ALLOCATION_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+
+// Number of global operator new calls (plain and over-aligned) since program start.
+// Counted by the replacement operators in allocation_counter.cpp.
+extern std::atomic<std::size_t> g_allocations;
+
+#endif // TS_BENCHMARK_ALLOCATION_COUNTER_H
@@ -1,12 +1,56 @@
 #include <benchmark/benchmark.h>
+#include "allocation_counter.h"
 #include <TSVector.h>
 #include <TSDeque.h>
+#include <TSBoundedQueue.h>
+#include <TSWorkStealingDeque.h>
+#include <TSTwoLockQueue.h>
+#include <TSSpscQueue.h>
+#include <TSPoolAllocator.h>
+#include <TSShardedDeque.h>
+#include <TSPriorityQueue.h>
+#include <TSLock.h>
+#include <TSCowVector.h>
+#include <TSReadMostlyVector.h>
+#include <TSConcurrentVector.h>
+#include <TSSnapshotPool.h>
+#include <TSUnorderedMap.h>
+#include <TSOrderedMap.h>
+#include <TSLruCache.h>
+#include <TSObjectPool.h>
 
 #include <thread>
 #include <vector>
 #include <deque>
 #include <random>
 #include <numeric>
+#include <queue>
+#include <coroutine>
+#include <chrono>
+#include <shared_mutex>
+#include <unordered_map>
+#include <map>
+#include <optional>
+#include <list>
+#include <cmath>
+#include <algorithm>
+
+// Reports the global allocations performed inside the timed loop, per iteration.
+class AllocationCounter {
+public:
+    explicit AllocationCounter(benchmark::State& state)
+        : state_(state), start_(g_allocations.load(std::memory_order_relaxed)) {}
+
+    ~AllocationCounter() {
+        size_t allocations = g_allocations.load(std::memory_order_relaxed) - start_;
+        state_.counters["allocs_per_iter"] = benchmark::Counter(
+            static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& state_;
+    size_t start_;
+};
 
 // --- Clear Benchmarks ---
 
@@ -123,6 +167,15 @@ static void BM_StdVector_PushBack(benchmark::State& state) {
 }
 BENCHMARK(BM_StdVector_PushBack)->Range(1 << 10, 1 << 18);
 
+static void BM_TSVector_AppendRange(benchmark::State& state) {
+    const auto data = generate_data(state.range(0));
+    for (auto _ : state) {
+        ts::vector<int> v;
+        v.append_range(data);
+    }
+}
+BENCHMARK(BM_TSVector_AppendRange)->Range(1 << 10, 1 << 18);
+
 // === ts::deque vs std::deque push_back/pop_front cycle ===
 
 static void BM_TSDeque_PushBackPopFront(benchmark::State& state) {
@@ -147,6 +200,64 @@ static void BM_StdDeque_PushBackPopFront(benchmark::State& state) {
 }
 BENCHMARK(BM_StdDeque_PushBackPopFront)->Range(1 << 10, 1 << 18);
 
+static void BM_TSBoundedQueue_PushBackPopFront(benchmark::State& state) {
+    ts::bounded_queue<int> q(state.range(0));
+    for (auto _ : state) {
+        for (int i = 0; i < state.range(0); ++i)
+            q.push_back(i);
+        while (q.pop_front_nullable())
+            ;
+    }
+}
+BENCHMARK(BM_TSBoundedQueue_PushBackPopFront)->Range(1 << 10, 1 << 18);
+
+static void BM_TSDeque_PushBackRangeDrain(benchmark::State& state) {
+    const auto data = generate_data(state.range(0));
+    std::vector<int> out;
+    for (auto _ : state) {
+        ts::deque<int> d;
+        d.push_back_range(data.begin(), data.end());
+        out.clear();
+        d.drain_into(out);
+    }
+}
+BENCHMARK(BM_TSDeque_PushBackRangeDrain)->Range(1 << 10, 1 << 18);
+
+// === ts::deque vs ts::bounded_queue under contention ===
+// Every thread pushes then pops, so the shared queue never holds more than one element per thread.
+
+static void BM_TSDeque_PushBackPopFront_MultiThreaded(benchmark::State& state) {
+    static ts::deque<int> d;
+
+    for (auto _ : state) {
+        d.push_back(1);
+        benchmark::DoNotOptimize(d.pop_front_nullable());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TSDeque_PushBackPopFront_MultiThreaded)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->UseRealTime();
+
+static void BM_TSBoundedQueue_PushBackPopFront_MultiThreaded(benchmark::State& state) {
+    static ts::bounded_queue<int> q(1024);
+
+    for (auto _ : state) {
+        q.push_back(1);
+        benchmark::DoNotOptimize(q.pop_front_nullable());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TSBoundedQueue_PushBackPopFront_MultiThreaded)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->UseRealTime();
+
 // === Snapshot of ts::vector during write ===
 
 static void BM_TSVector_SnapshotWhilePushing(benchmark::State& state) {
@@ -264,6 +375,56 @@ static void BM_TSVector_EraseIf(benchmark::State& state) {
 }
 BENCHMARK(BM_TSVector_EraseIf)->Range(1 << 10, 1 << 18);
 
+// Times only the erase; the second argument is parallel_policy::max_threads (1 = sequential overload).
+static void BM_TSVector_EraseIf_Parallel(benchmark::State& state) {
+    std::vector<int> source(static_cast<size_t>(state.range(0)));
+    std::iota(source.begin(), source.end(), 0);
+    ts::parallel_policy policy{.threshold = 0, .max_threads = static_cast<unsigned>(state.range(1))};
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        ts::vector<int> v(source);
+        state.ResumeTiming();
+        if (policy.max_threads == 1) {
+            v.erase_if([](int x) { return x % 2 == 0; });
+        } else {
+            v.erase_if(policy, [](int x) { return x % 2 == 0; });
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TSVector_EraseIf_Parallel)
+    ->ArgsProduct({{1 << 10, 1 << 14, 1 << 18, 1 << 20}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+// Lambda vs. ts::pred object on the same data: the second takes the SIMD kernel.
+template <typename T, bool PredicateObject>
+static void BM_TSVector_EraseIf_Filter(benchmark::State& state) {
+    std::vector<T> source(static_cast<size_t>(state.range(0)));
+    std::mt19937 rng(1);
+    for (T& x : source) x = static_cast<T>(rng() % 1000);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        ts::vector<T> v(source);
+        state.ResumeTiming();
+        if constexpr (PredicateObject) {
+            v.erase_if(ts::pred::less{T(500)});
+        } else {
+            v.erase_if([](T x) { return x < T(500); });
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TSVector_EraseIf_Filter<int, false>)->Range(1 << 14, 1 << 20);
+BENCHMARK(BM_TSVector_EraseIf_Filter<int, true>)->Range(1 << 14, 1 << 20);
+BENCHMARK(BM_TSVector_EraseIf_Filter<float, false>)->Range(1 << 14, 1 << 20);
+BENCHMARK(BM_TSVector_EraseIf_Filter<float, true>)->Range(1 << 14, 1 << 20);
+BENCHMARK(BM_TSVector_EraseIf_Filter<uint64_t, false>)->Range(1 << 14, 1 << 20);
+BENCHMARK(BM_TSVector_EraseIf_Filter<uint64_t, true>)->Range(1 << 14, 1 << 20);
+
 // --- Snapshot (Large Copy) Benchmark ---
 
 static void BM_TSVector_Snapshot(benchmark::State& state) {
@@ -278,6 +439,62 @@ static void BM_TSVector_Snapshot(benchmark::State& state) {
 }
 BENCHMARK(BM_TSVector_Snapshot)->Range(1 << 10, 1 << 18);
 
+// Same copy as BM_TSVector_Snapshot, but into reused storage; compare allocs_per_iter.
+static void BM_TSVector_SnapshotAlloc(benchmark::State& state) {
+    ts::vector<int> v;
+    for (int i = 0; i < state.range(0); ++i)
+        v.push_back(i);
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        auto copy = v.snapshot();
+        benchmark::DoNotOptimize(copy.data());
+    }
+}
+BENCHMARK(BM_TSVector_SnapshotAlloc)->Range(1 << 10, 1 << 18);
+
+static void BM_TSVector_SnapshotInto(benchmark::State& state) {
+    ts::vector<int> v;
+    for (int i = 0; i < state.range(0); ++i)
+        v.push_back(i);
+    std::vector<int> out;
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        v.snapshot_into(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_TSVector_SnapshotInto)->Range(1 << 10, 1 << 18);
+
+static void BM_TSVector_SnapshotPool(benchmark::State& state) {
+    ts::vector<int> v;
+    for (int i = 0; i < state.range(0); ++i)
+        v.push_back(i);
+    ts::snapshot_pool<int> pool;
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        auto snap = pool.take(v);
+        benchmark::DoNotOptimize(snap->data());
+    }
+}
+BENCHMARK(BM_TSVector_SnapshotPool)->Range(1 << 10, 1 << 18);
+
+static void BM_TSDeque_SnapshotInto(benchmark::State& state) {
+    ts::deque<int> d;
+    for (int i = 0; i < state.range(0); ++i)
+        d.push_back(i);
+    std::vector<int> out;
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        d.snapshot_into(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_TSDeque_SnapshotInto)->Range(1 << 10, 1 << 18);
+
 // --- TSDeque PopBack ---
 
 static void BM_TSDeque_PopBack(benchmark::State& state) {
@@ -394,4 +611,878 @@ BENCHMARK(BM_TSVector_ConcurrentReaders)
     ->Range(1024, 262144)
     ->Threads(2)
     ->Threads(4)
-    ->Threads(8);
\ No newline at end of file
+    ->Threads(8);
+
+// === Fork-join tree walk: ts::work_stealing_deque vs ts::deque ===
+// Each task is a subtree depth; inner nodes fork two children, leaves are counted.
+// Workers run their own deque LIFO and steal FIFO from the others when it runs dry.
+
+struct WorkStealingScheduler {
+    using queue_type = ts::work_stealing_deque<int>;
+    static void push(queue_type& q, int task) { q.push_back(task); }
+    static std::optional<int> pop(queue_type& q) { return q.pop_back_nullable(); }
+    static std::optional<int> steal(queue_type& q) { return q.steal(); }
+};
+
+struct MutexDequeScheduler {
+    using queue_type = ts::deque<int>;
+    static void push(queue_type& q, int task) { q.push_back(task); }
+    static std::optional<int> pop(queue_type& q) { return q.pop_back_nullable(); }
+    static std::optional<int> steal(queue_type& q) { return q.pop_front_nullable(); }
+};
+
+template <typename Scheduler>
+static long long run_tree_walk(int workers, int depth) {
+    std::vector<std::unique_ptr<typename Scheduler::queue_type>> queues;
+    for (int w = 0; w < workers; ++w)
+        queues.push_back(std::make_unique<typename Scheduler::queue_type>());
+
+    std::atomic<long long> pending{1};
+    std::atomic<long long> leaves{0};
+    Scheduler::push(*queues[0], depth);
+
+    auto worker = [&](int self) {
+        long long local_leaves = 0;
+        unsigned victim = self;
+        while (pending.load(std::memory_order_acquire) != 0) {
+            auto task = Scheduler::pop(*queues[self]);
+            for (int attempt = 0; !task && attempt < workers - 1; ++attempt) {
+                victim = (victim + 1) % workers;
+                if (victim != static_cast<unsigned>(self))
+                    task = Scheduler::steal(*queues[victim]);
+            }
+            if (!task) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            if (*task == 0) {
+                ++local_leaves;
+            } else {
+                pending.fetch_add(2, std::memory_order_relaxed);
+                Scheduler::push(*queues[self], *task - 1);
+                Scheduler::push(*queues[self], *task - 1);
+            }
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        leaves.fetch_add(local_leaves, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 1; w < workers; ++w)
+        threads.emplace_back(worker, w);
+    worker(0);
+    for (auto& t : threads) t.join();
+
+    return leaves.load();
+}
+
+static void BM_TSWorkStealingDeque_TreeWalk(benchmark::State& state) {
+    const int workers = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(run_tree_walk<WorkStealingScheduler>(workers, 16));
+    }
+    state.SetItemsProcessed(state.iterations() * ((1 << 17) - 1));
+}
+BENCHMARK(BM_TSWorkStealingDeque_TreeWalk)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+static void BM_TSDeque_TreeWalk(benchmark::State& state) {
+    const int workers = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(run_tree_walk<MutexDequeScheduler>(workers, 16));
+    }
+    state.SetItemsProcessed(state.iterations() * ((1 << 17) - 1));
+}
+BENCHMARK(BM_TSDeque_TreeWalk)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+// === Producer/consumer ratio sweep: ts::two_lock_queue vs ts::deque ===
+// Args are {producers, consumers}; each iteration moves a fixed number of items end to end.
+
+template <typename Queue>
+static void run_producer_consumer(benchmark::State& state) {
+    const int producers = static_cast<int>(state.range(0));
+    const int consumers = static_cast<int>(state.range(1));
+    constexpr int total_items = 1 << 16;
+    const int per_producer = total_items / producers;
+    const int total = per_producer * producers;
+
+    for (auto _ : state) {
+        Queue q;
+        std::atomic<int> consumed{0};
+        std::vector<std::thread> threads;
+
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < per_producer; ++i)
+                    q.push_back(i);
+            });
+        }
+        for (int c = 0; c < consumers; ++c) {
+            threads.emplace_back([&] {
+                while (consumed.load(std::memory_order_relaxed) < total) {
+                    if (q.pop_front_nullable())
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    else
+                        std::this_thread::yield();
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+    state.SetItemsProcessed(state.iterations() * total);
+}
+
+static void BM_TSTwoLockQueue_ProducerConsumer(benchmark::State& state) {
+    run_producer_consumer<ts::two_lock_queue<int>>(state);
+}
+BENCHMARK(BM_TSTwoLockQueue_ProducerConsumer)
+    ->ArgsProduct({{1, 2, 4, 8}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+static void BM_TSDeque_ProducerConsumer(benchmark::State& state) {
+    run_producer_consumer<ts::deque<int>>(state);
+}
+BENCHMARK(BM_TSDeque_ProducerConsumer)
+    ->ArgsProduct({{1, 2, 4, 8}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+// === One-way hand-off latency: SPSC queues vs ts::deque ===
+// Ping-pong between two threads over a pair of queues; one_way_latency is half the round trip.
+
+template <typename Queue>
+static void run_ping_pong(benchmark::State& state, Queue& ping, Queue& pong) {
+    std::atomic<bool> running{true};
+
+    std::thread echo([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            if (auto value = ping.pop_front_nullable())
+                pong.push_back(*value);
+        }
+    });
+
+    int round_trips = 0;
+    for (auto _ : state) {
+        ping.push_back(round_trips);
+        std::optional<int> value;
+        while (!(value = pong.pop_front_nullable()))
+            ;
+        benchmark::DoNotOptimize(value);
+        ++round_trips;
+    }
+
+    running = false;
+    echo.join();
+    state.counters["one_way_latency"] = benchmark::Counter(
+        2.0 * state.iterations(), benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+static void BM_TSSpscQueue_HandOffLatency(benchmark::State& state) {
+    ts::spsc_queue<int> ping(1024), pong(1024);
+    run_ping_pong(state, ping, pong);
+}
+BENCHMARK(BM_TSSpscQueue_HandOffLatency)->UseRealTime();
+
+static void BM_TSUnboundedSpscQueue_HandOffLatency(benchmark::State& state) {
+    ts::unbounded_spsc_queue<int> ping, pong;
+    run_ping_pong(state, ping, pong);
+}
+BENCHMARK(BM_TSUnboundedSpscQueue_HandOffLatency)->UseRealTime();
+
+static void BM_TSDeque_HandOffLatency(benchmark::State& state) {
+    ts::deque<int> ping, pong;
+    run_ping_pong(state, ping, pong);
+}
+BENCHMARK(BM_TSDeque_HandOffLatency)->UseRealTime();
+
+// === Steady-state push/pop: std::allocator vs ts::pool_allocator ===
+// The container is reused across iterations, so after warm-up the pool should report zero allocations.
+
+template <typename Deque>
+static void run_deque_steady_state(benchmark::State& state) {
+    Deque d;
+    for (int i = 0; i < state.range(0); ++i) d.push_back(i);
+    while (d.pop_front_nullable()) {}
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        for (int i = 0; i < state.range(0); ++i)
+            d.push_back(i);
+        while (d.pop_front_nullable())
+            ;
+    }
+}
+
+static void BM_TSDeque_SteadyState_StdAllocator(benchmark::State& state) {
+    run_deque_steady_state<ts::deque<int>>(state);
+}
+BENCHMARK(BM_TSDeque_SteadyState_StdAllocator)->Range(1 << 10, 1 << 16);
+
+static void BM_TSDeque_SteadyState_PoolAllocator(benchmark::State& state) {
+    run_deque_steady_state<ts::deque<int, ts::pool_allocator<int>>>(state);
+}
+BENCHMARK(BM_TSDeque_SteadyState_PoolAllocator)->Range(1 << 10, 1 << 16);
+
+template <typename Vector>
+static void run_vector_fill(benchmark::State& state) {
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        Vector v;
+        for (int i = 0; i < state.range(0); ++i)
+            v.push_back(i);
+    }
+}
+
+static void BM_TSVector_PushBack_StdAllocator(benchmark::State& state) {
+    run_vector_fill<ts::vector<int>>(state);
+}
+BENCHMARK(BM_TSVector_PushBack_StdAllocator)->Range(1 << 10, 1 << 14);
+
+static void BM_TSVector_PushBack_PoolAllocator(benchmark::State& state) {
+    run_vector_fill<ts::vector<int, ts::pool_allocator<int>>>(state);
+}
+BENCHMARK(BM_TSVector_PushBack_PoolAllocator)->Range(1 << 10, 1 << 14);
+
+// === Push scaling: ts::sharded_deque vs ts::deque ===
+// Each thread pushes and pops its own item; with one shard per thread the sharded deque never contends.
+
+static void BM_TSDeque_PushScaling(benchmark::State& state) {
+    static ts::deque<int> d;
+    for (auto _ : state) {
+        d.push_back(1);
+        benchmark::DoNotOptimize(d.pop_front_nullable());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TSDeque_PushScaling)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_TSShardedDeque_PushScaling(benchmark::State& state) {
+    static ts::sharded_deque<int> d(16);
+    for (auto _ : state) {
+        d.push_back(1);
+        benchmark::DoNotOptimize(d.pop_front_nullable());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TSShardedDeque_PushScaling)->ThreadRange(1, 16)->UseRealTime();
+
+// === ts::priority_queue vs mutex-wrapped std::priority_queue ===
+
+class LockedStdPriorityQueue {
+public:
+    void push(int value) {
+        std::lock_guard lock(mutex_);
+        data_.push(value);
+    }
+
+    std::optional<int> try_pop() {
+        std::lock_guard lock(mutex_);
+        if (data_.empty())
+            return std::nullopt;
+        int value = data_.top();
+        data_.pop();
+        return value;
+    }
+
+private:
+    std::mutex mutex_;
+    std::priority_queue<int> data_;
+};
+
+// Each thread pushes one random key and pops one, around a prefilled queue.
+template <typename Queue>
+static void run_priority_queue_throughput(benchmark::State& state, Queue& q) {
+    std::mt19937 rng(state.thread_index());
+    if (state.thread_index() == 0) {
+        for (int i = 0; i < (1 << 16); ++i)
+            q.push(static_cast<int>(rng()));
+    }
+
+    for (auto _ : state) {
+        q.push(static_cast<int>(rng()));
+        benchmark::DoNotOptimize(q.try_pop());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_TSPriorityQueue_PushPop(benchmark::State& state) {
+    static ts::priority_queue<int> q(32);
+    run_priority_queue_throughput(state, q);
+}
+BENCHMARK(BM_TSPriorityQueue_PushPop)->ThreadRange(1, 16)->UseRealTime();
+
+static void BM_LockedStdPriorityQueue_PushPop(benchmark::State& state) {
+    static LockedStdPriorityQueue q;
+    run_priority_queue_throughput(state, q);
+}
+BENCHMARK(BM_LockedStdPriorityQueue_PushPop)->ThreadRange(1, 16)->UseRealTime();
+
+// Rank error: how many still-queued keys outranked each popped key (0 for an exact queue).
+// Keys are a permutation of [0, n); a Fenwick tree tracks which are still queued.
+static void BM_TSPriorityQueue_RankError(benchmark::State& state) {
+    const int n = static_cast<int>(state.range(1));
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    double total_error = 0;
+    long long pops = 0;
+    for (auto _ : state) {
+        ts::priority_queue<int> q(state.range(0));
+        for (int key : keys)
+            q.push(key);
+
+        std::vector<int> tree(n + 1, 0);
+        auto add = [&](int index, int delta) {
+            for (++index; index <= n; index += index & -index) tree[index] += delta;
+        };
+        auto prefix = [&](int index) {
+            int sum = 0;
+            for (++index; index > 0; index -= index & -index) sum += tree[index];
+            return sum;
+        };
+        for (int key = 0; key < n; ++key)
+            add(key, 1);
+
+        while (auto key = q.try_pop()) {
+            total_error += prefix(n - 1) - prefix(*key);
+            add(*key, -1);
+            ++pops;
+        }
+    }
+    state.counters["mean_rank_error"] = pops ? total_error / pops : 0;
+}
+BENCHMARK(BM_TSPriorityQueue_RankError)->ArgsProduct({{2, 8, 32, 128}, {1 << 14}});
+
+// === Coroutine consumers: 10k suspended async_pop_front() waiters, a few producers ===
+// Producers push steady_clock timestamps; each resumed coroutine records how long its value waited.
+
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+static long long now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static DetachedTask timed_consumer(ts::deque<long long>& d, std::atomic<long long>& total_latency) {
+    long long pushed_at = co_await d.async_pop_front();
+    total_latency.fetch_add(now_ns() - pushed_at, std::memory_order_relaxed);
+}
+
+static void BM_TSDeque_CoroutineResumeLatency(benchmark::State& state) {
+    constexpr int consumers = 10000;
+    const int producers = static_cast<int>(state.range(0));
+    std::atomic<long long> total_latency{0};
+
+    for (auto _ : state) {
+        ts::deque<long long> d;
+        for (int i = 0; i < consumers; ++i)
+            timed_consumer(d, total_latency);
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < consumers / producers; ++i)
+                    d.push_back(now_ns());
+            });
+        }
+        for (auto& t : threads) t.join();
+    }
+
+    state.SetItemsProcessed(state.iterations() * consumers);
+    state.counters["mean_resume_ns"] = static_cast<double>(total_latency.load()) /
+        static_cast<double>(state.iterations() * (consumers / producers) * producers);
+}
+BENCHMARK(BM_TSDeque_CoroutineResumeLatency)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+// === Lock policies under contention ===
+// Same shared push/pop loop as BM_TSDeque_PushBackPopFront_MultiThreaded, parameterised on the lock.
+// ts::null_mutex is only measured single-threaded, the one setting where it is valid.
+
+#define TS_LOCK_POLICY_BENCHMARKS(bench)                                                        \
+    BENCHMARK_TEMPLATE(bench, std::mutex)->ThreadRange(1, 32)->UseRealTime();                     \
+    BENCHMARK_TEMPLATE(bench, std::shared_mutex)->ThreadRange(1, 32)->UseRealTime();              \
+    BENCHMARK_TEMPLATE(bench, ts::spinlock)->ThreadRange(1, 32)->UseRealTime();                   \
+    BENCHMARK_TEMPLATE(bench, ts::adaptive_mutex)->ThreadRange(1, 32)->UseRealTime();             \
+    BENCHMARK_TEMPLATE(bench, ts::flat_combining_mutex)->ThreadRange(1, 32)->UseRealTime();       \
+    BENCHMARK_TEMPLATE(bench, ts::null_mutex)->Threads(1)->UseRealTime()
+
+template <class Lock>
+static void BM_TSDeque_PushPop_Lock(benchmark::State& state) {
+    static ts::deque<int, std::allocator<int>, Lock> d;
+
+    for (auto _ : state) {
+        d.push_back(1);
+        benchmark::DoNotOptimize(d.pop_front_nullable());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+TS_LOCK_POLICY_BENCHMARKS(BM_TSDeque_PushPop_Lock);
+
+template <class Lock>
+static void BM_TSVector_PushBack_Lock(benchmark::State& state) {
+    static ts::vector<int, std::allocator<int>, Lock> vec;
+    if (state.thread_index() == 0) {
+        vec.clear();
+    }
+
+    for (auto _ : state) {
+        vec.push_back(1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+TS_LOCK_POLICY_BENCHMARKS(BM_TSVector_PushBack_Lock);
+
+// === Reader scaling: shared vs exclusive locking ===
+// Every thread but one only reads (size() plus a read() pass); thread 0 keeps appending.
+
+template <class Lock>
+static void BM_TSVector_ReadMostly_Lock(benchmark::State& state) {
+    static ts::vector<int, std::allocator<int>, Lock> vec(std::vector<int>(1024, 1));
+
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            vec.push_back(1);
+            vec.pop_back();
+        } else {
+            benchmark::DoNotOptimize(vec.size());
+            benchmark::DoNotOptimize(vec.read([](const auto& data) {
+                return std::accumulate(data.begin(), data.begin() + 64, 0);
+            }));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_TSVector_ReadMostly_Lock, std::mutex)
+    ->Threads(2)->Threads(4)->Threads(8)->Threads(16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TSVector_ReadMostly_Lock, std::shared_mutex)
+    ->Threads(2)->Threads(4)->Threads(8)->Threads(16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TSVector_ReadMostly_Lock, ts::spinlock)
+    ->Threads(2)->Threads(4)->Threads(8)->Threads(16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_TSVector_ReadMostly_Lock, ts::adaptive_mutex)
+    ->Threads(2)->Threads(4)->Threads(8)->Threads(16)->UseRealTime();
+
+// === Copy-on-write snapshots: O(1) handle vs full copy (compare with BM_TSVector_Snapshot) ===
+
+static void BM_TSCowVector_Snapshot(benchmark::State& state) {
+    ts::cow_vector<int> v;
+    for (int i = 0; i < state.range(0); ++i)
+        v.push_back(i);
+
+    for (auto _ : state) {
+        auto handle = v.snapshot();
+        benchmark::DoNotOptimize(handle);
+    }
+}
+BENCHMARK(BM_TSCowVector_Snapshot)->Range(1 << 10, 1 << 18);
+
+// Exporter-style workload: thread 0 snapshots and sums the data, the others keep writing.
+// Reports the writers' throughput, which is what a full-copy snapshot stalls.
+template <class Vector>
+static void BM_SnapshotExporter(benchmark::State& state) {
+    static Vector v;
+    if (state.thread_index() == 0) {
+        v.clear();
+        for (int i = 0; i < 1 << 16; ++i) v.push_back(i);
+    }
+
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            auto snap = v.snapshot();
+            if constexpr (std::is_same_v<Vector, ts::cow_vector<int>>) {
+                benchmark::DoNotOptimize(std::accumulate(snap->begin(), snap->end(), 0LL));
+            } else {
+                benchmark::DoNotOptimize(std::accumulate(snap.begin(), snap.end(), 0LL));
+            }
+        } else {
+            v.push_back(1);
+            v.pop_back();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SnapshotExporter, ts::vector<int>)->Threads(2)->Threads(4)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SnapshotExporter, ts::cow_vector<int>)->Threads(2)->Threads(4)->UseRealTime();
+
+// === Read-mostly vector: reader scaling with a background writer ===
+// Every benchmark thread reads (sums the first 64 elements); one extra thread publishes a
+// new version every 100 us. Compare lock-free epoch readers with shared-lock readers.
+
+template <class Vector>
+static void BM_ReadMostly_Readers(benchmark::State& state) {
+    static Vector vec(std::vector<int>(1024, 1));
+    static std::atomic<bool> writer_running{false};
+    static std::thread writer;
+
+    if (state.thread_index() == 0) {
+        writer_running = true;
+        writer = std::thread([] {
+            int i = 0;
+            while (writer_running.load(std::memory_order_relaxed)) {
+                auto touch = [&](auto& data) { data[i++ % data.size()] = 1; };
+                if constexpr (requires { vec.update(touch); }) {
+                    vec.update(touch);
+                } else {
+                    vec.process(touch);
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(vec.read([](const auto& data) {
+            return std::accumulate(data.begin(), data.begin() + 64, 0);
+        }));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        writer_running = false;
+        writer.join();
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_ReadMostly_Readers, ts::read_mostly_vector<int>)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ReadMostly_Readers, ts::vector<int, std::allocator<int>, std::shared_mutex>)
+    ->ThreadRange(1, 32)->UseRealTime();
+
+// === Segmented concurrent_vector vs ts::vector appends (see BM_TSVector_PushBack_MultiThreaded) ===
+
+template <class Vector>
+static void BM_SharedAppend(benchmark::State& state) {
+    static Vector* vec = nullptr;
+    if (state.thread_index() == 0) {
+        delete vec;
+        vec = new Vector;
+    }
+
+    for (auto _ : state) {
+        vec->push_back(1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_SharedAppend, ts::vector<int>)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SharedAppend, ts::concurrent_vector<int>)->ThreadRange(1, 16)->UseRealTime();
+
+// === Incremental polling: snapshot_since vs full snapshot() ===
+// A writer appends `range(0)` elements in small batches; the poller copies either the whole
+// vector or only the new tail after every batch (as BM_TSVector_ConcurrentSnapshot's readers do).
+
+static void BM_TSVector_PollFullSnapshot(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        ts::vector<int> vec;
+        size_t copied = 0;
+        for (int i = 0; i < count; i += 64) {
+            for (int j = 0; j < 64; ++j) vec.push_back(i + j);
+            auto snap = vec.snapshot();
+            benchmark::DoNotOptimize(snap.data());
+            copied += snap.size();
+        }
+        benchmark::DoNotOptimize(copied);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_TSVector_PollFullSnapshot)->Range(1 << 10, 1 << 16);
+
+static void BM_TSVector_PollSnapshotSince(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        ts::vector<int> vec;
+        ts::vector<int>::cursor position;
+        size_t copied = 0;
+        for (int i = 0; i < count; i += 64) {
+            for (int j = 0; j < 64; ++j) vec.push_back(i + j);
+            auto d = vec.snapshot_since(position);
+            benchmark::DoNotOptimize(d.elements.data());
+            copied += d.elements.size();
+            position = d.next;
+        }
+        benchmark::DoNotOptimize(copied);
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_TSVector_PollSnapshotSince)->Range(1 << 10, 1 << 16);
+
+// === Lock-striped ts::unordered_map vs one mutex around std::unordered_map ===
+// 90% find / 10% insert_or_assign over 64K pre-populated keys, per-thread random streams.
+
+class LockedStdUnorderedMap {
+public:
+    std::optional<int> find(int key) const {
+        std::lock_guard lock(mutex_);
+        auto it = map_.find(key);
+        return it == map_.end() ? std::nullopt : std::optional<int>(it->second);
+    }
+
+    bool insert_or_assign(int key, int value) {
+        std::lock_guard lock(mutex_);
+        return map_.insert_or_assign(key, value).second;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<int, int> map_;
+};
+
+template <class Map>
+static void BM_Map_GetPut(benchmark::State& state) {
+    constexpr int keys = 1 << 16;
+    static Map* map = nullptr;
+    if (state.thread_index() == 0) {
+        delete map;
+        map = new Map;
+        for (int k = 0; k < keys; ++k) map->insert_or_assign(k, k);
+    }
+
+    std::mt19937 rng(static_cast<unsigned>(state.thread_index()) + 1);
+    for (auto _ : state) {
+        unsigned r = rng();
+        int key = static_cast<int>(r % keys);
+        if ((r >> 20) % 10 == 0) {
+            map->insert_or_assign(key, static_cast<int>(r));
+        } else {
+            benchmark::DoNotOptimize(map->find(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_Map_GetPut, LockedStdUnorderedMap)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Map_GetPut, ts::unordered_map<int, int>)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Map_GetPut, ts::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                                                     std::allocator<std::pair<const int, int>>, std::shared_mutex>)
+    ->ThreadRange(1, 32)->UseRealTime();
+
+// === Skip-list ts::ordered_map vs one mutex around std::map ===
+// 70% find, 15% insert_or_assign, 10% erase, 5% range scan over 64 keys; 64K key space.
+
+class LockedStdMap {
+public:
+    std::optional<int> find(int key) const {
+        std::lock_guard lock(mutex_);
+        auto it = map_.find(key);
+        return it == map_.end() ? std::nullopt : std::optional<int>(it->second);
+    }
+
+    bool insert_or_assign(int key, int value) {
+        std::lock_guard lock(mutex_);
+        return map_.insert_or_assign(key, value).second;
+    }
+
+    bool erase(int key) {
+        std::lock_guard lock(mutex_);
+        return map_.erase(key) != 0;
+    }
+
+    template <typename F>
+    void for_each_range(int lo, int hi, F&& callback) const {
+        std::lock_guard lock(mutex_);
+        for (auto it = map_.lower_bound(lo); it != map_.end() && it->first < hi; ++it) {
+            callback(it->first, it->second);
+        }
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::map<int, int> map_;
+};
+
+template <class Map>
+static void BM_OrderedMap_Mixed(benchmark::State& state) {
+    constexpr int keys = 1 << 16;
+    static Map* map = nullptr;
+    if (state.thread_index() == 0) {
+        delete map;
+        map = new Map;
+        for (int k = 0; k < keys; k += 2) map->insert_or_assign(k, k);
+    }
+
+    std::mt19937 rng(static_cast<unsigned>(state.thread_index()) + 1);
+    for (auto _ : state) {
+        unsigned r = rng();
+        int key = static_cast<int>(r % keys);
+        unsigned op = (r >> 16) % 100;
+        if (op < 70) {
+            benchmark::DoNotOptimize(map->find(key));
+        } else if (op < 85) {
+            map->insert_or_assign(key, key);
+        } else if (op < 95) {
+            map->erase(key);
+        } else {
+            long sum = 0;
+            map->for_each_range(key, key + 64, [&](const int&, const int& value) { sum += value; });
+            benchmark::DoNotOptimize(sum);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_OrderedMap_Mixed, LockedStdMap)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_OrderedMap_Mixed, ts::ordered_map<int, int>)->ThreadRange(1, 16)->UseRealTime();
+
+// === Sharded CLOCK ts::lru_cache vs one mutex around a std::list LRU ===
+// Zipfian (s = 0.99) keys over a 1M key space, cache capacity 64K; a miss loads key * 2.
+// Reports hit_rate next to throughput, so eviction quality and scalability show together.
+
+class ZipfianKeys {
+public:
+    ZipfianKeys(size_t keys, double skew) : cdf_(keys) {
+        double sum = 0;
+        for (size_t i = 0; i < keys; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), skew);
+            cdf_[i] = sum;
+        }
+        for (double& c : cdf_) c /= sum;
+    }
+
+    template <typename Rng>
+    int operator()(Rng& rng) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        auto rank = static_cast<size_t>(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin());
+        // Scatter the ranks so that hot keys do not sit next to each other.
+        return static_cast<int>((rank * 0x9E3779B1u) % cdf_.size());
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+class LockedListLru {
+public:
+    explicit LockedListLru(size_t capacity) : capacity_(capacity) {}
+
+    template <typename Loader>
+    int get_or_load(int key, Loader&& loader) {
+        std::lock_guard lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            ++hits_;
+            order_.splice(order_.begin(), order_, it->second);
+            return it->second->second;
+        }
+        ++misses_;
+        int value = loader();
+        order_.emplace_front(key, value);
+        index_[key] = order_.begin();
+        if (order_.size() > capacity_) {
+            index_.erase(order_.back().first);
+            order_.pop_back();
+        }
+        return value;
+    }
+
+    ts::cache_stats stats() const {
+        std::lock_guard lock(mutex_);
+        return {hits_, misses_, 0};
+    }
+
+private:
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::list<std::pair<int, int>> order_;
+    std::unordered_map<int, std::list<std::pair<int, int>>::iterator> index_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+template <class Cache>
+static void BM_Cache_Zipfian(benchmark::State& state) {
+    constexpr size_t keys = 1 << 20;
+    constexpr size_t capacity = 1 << 16;
+    static const ZipfianKeys zipf(keys, 0.99);
+    static Cache* cache = nullptr;
+    if (state.thread_index() == 0) {
+        delete cache;
+        cache = new Cache(capacity);
+    }
+
+    std::mt19937_64 rng(static_cast<unsigned>(state.thread_index()) + 1);
+    for (auto _ : state) {
+        int key = zipf(rng);
+        benchmark::DoNotOptimize(cache->get_or_load(key, [key] { return key * 2; }));
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        ts::cache_stats stats = cache->stats();
+        state.counters["hit_rate"] = static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses);
+    }
+}
+BENCHMARK_TEMPLATE(BM_Cache_Zipfian, LockedListLru)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Cache_Zipfian, ts::lru_cache<int, int>)->ThreadRange(1, 16)->UseRealTime();
+
+// === ts::object_pool vs new/delete vs recycling through ts::deque<std::unique_ptr<T>> ===
+// Each iteration takes 4 KiB buffers, writes to them and gives them back.
+
+struct PooledBuffer {
+    std::vector<char> bytes;
+};
+
+class NewDeleteBuffers {
+public:
+    std::unique_ptr<PooledBuffer> acquire() {
+        return std::make_unique<PooledBuffer>();
+    }
+
+    void release(std::unique_ptr<PooledBuffer>) {}
+};
+
+class DequeRecycledBuffers {
+public:
+    std::unique_ptr<PooledBuffer> acquire() {
+        if (auto recycled = free_.pop_back_nullable()) {
+            return std::move(*recycled);
+        }
+        return std::make_unique<PooledBuffer>();
+    }
+
+    void release(std::unique_ptr<PooledBuffer> buffer) {
+        free_.push_back(std::move(buffer));
+    }
+
+private:
+    ts::deque<std::unique_ptr<PooledBuffer>> free_;
+};
+
+class ObjectPoolBuffers {
+public:
+    ts::object_pool<PooledBuffer>::handle acquire() {
+        return pool_.acquire();
+    }
+
+    void release(ts::object_pool<PooledBuffer>::handle) {}
+
+private:
+    ts::object_pool<PooledBuffer> pool_;
+};
+
+template <class Buffers>
+static void BM_ObjectPool_AcquireRelease(benchmark::State& state) {
+    static Buffers* buffers = nullptr;
+    if (state.thread_index() == 0) {
+        delete buffers;
+        buffers = new Buffers;
+    }
+
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        auto first = buffers->acquire();
+        auto second = buffers->acquire();
+        first->bytes.resize(4096);
+        second->bytes.resize(4096);
+        first->bytes[0] = second->bytes[4095] = 1;
+        benchmark::DoNotOptimize(first->bytes.data());
+        buffers->release(std::move(second));
+        buffers->release(std::move(first));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK_TEMPLATE(BM_ObjectPool_AcquireRelease, NewDeleteBuffers)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ObjectPool_AcquireRelease, DequeRecycledBuffers)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ObjectPool_AcquireRelease, ObjectPoolBuffers)->ThreadRange(1, 16)->UseRealTime();
@@ -0,0 +1,187 @@
+#ifndef TS_BOUNDED_QUEUE_H
+#define TS_BOUNDED_QUEUE_H
+
+#include "TSCommon.h"
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <cstdint>
+
+namespace ts {
+
+/**
+ * @brief Lock-free bounded multi-producer / multi-consumer FIFO queue.
+ *
+ * Elements live in a preallocated ring whose size is rounded up to a power of two.
+ * Every slot carries a sequence number that tells producers and consumers whether the
+ * slot is free for the current lap, so a push or pop is one CAS on the tail / head
+ * counter plus one release store on the slot. Nothing is allocated after construction.
+ *
+ * The push_back / pop_front_nullable shape matches ts::deque. push_back and pop_front
+ * spin (yielding) while the queue is full / empty; use the try_ variants to fail instead.
+ *
+ * Once a push or pop has claimed a slot it must finish, or the slot's sequence never
+ * advances and every later lap blocks on it. T must therefore be nothrow move constructible,
+ * and an element whose constructor may throw is built before a slot is claimed and then
+ * moved in, so a throwing constructor leaves the queue untouched.
+ */
+template <typename T>
+class bounded_queue {
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "ts::bounded_queue needs a nothrow move constructor: a throw inside a claimed slot wedges the ring");
+
+public:
+    explicit bounded_queue(size_t capacity)
+        : mask_(detail::round_up_pow2(capacity < 2 ? 2 : capacity) - 1),
+          slots_(std::make_unique<slot[]>(mask_ + 1)) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bounded_queue(const bounded_queue&) = delete;
+    bounded_queue& operator=(const bounded_queue&) = delete;
+
+    ~bounded_queue() {
+        while (pop_front_nullable()) {
+        }
+    }
+
+    NO_DISCARD size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    /**
+     * @brief Number of stored elements; only a hint while other threads are pushing or popping.
+     */
+    NO_DISCARD size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    NO_DISCARD bool empty() const {
+        return size() == 0;
+    }
+
+    template <class... Args>
+    NO_DISCARD bool try_emplace_back(Args&&... args) {
+        if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+            return emplace_claimed(std::forward<Args>(args)...);
+        } else {
+            // Construct outside the ring; only the nothrow move runs inside the claimed slot.
+            T value(std::forward<Args>(args)...);
+            return emplace_claimed(std::move(value));
+        }
+    }
+
+    NO_DISCARD bool try_push_back(const T& value) {
+        return try_emplace_back(value);
+    }
+
+    NO_DISCARD bool try_push_back(T&& value) {
+        return try_emplace_back(std::move(value));
+    }
+
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        T value(std::forward<Args>(args)...);
+        push_back(std::move(value));
+    }
+
+    void push_back(const T& value) {
+        // Copied once up front: a throwing copy must not happen inside a claimed slot.
+        T copy(value);
+        push_back(std::move(copy));
+    }
+
+    void push_back(T&& value) {
+        while (!try_emplace_back(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+
+    NO_DISCARD std::optional<T> pop_front_nullable() {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        slot* s;
+
+        for (;;) {
+            s = &slots_[pos & mask_];
+            size_t seq = s->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return std::nullopt;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Nothrow (checked above), so the slot is always released for the next lap.
+        T* element = std::launder(reinterpret_cast<T*>(s->storage));
+        std::optional<T> value(std::move(*element));
+        element->~T();
+        s->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return value;
+    }
+
+    NO_DISCARD T pop_front() {
+        for (;;) {
+            if (auto value = pop_front_nullable()) {
+                return std::move(*value);
+            }
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    struct slot {
+        std::atomic<size_t> sequence{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // Claims the tail slot and constructs the element in it; the constructor must not throw.
+    template <class... Args>
+    bool emplace_claimed(Args&&... args) noexcept {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        slot* s;
+
+        for (;;) {
+            s = &slots_[pos & mask_];
+            size_t seq = s->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        ::new (static_cast<void*>(s->storage)) T(std::forward<Args>(args)...);
+        s->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    const size_t mask_;
+    const std::unique_ptr<slot[]> slots_;
+
+    alignas(detail::cache_line_size) std::atomic<size_t> tail_{0};
+    alignas(detail::cache_line_size) std::atomic<size_t> head_{0};
+};
+
+} // namespace ts
+
+#endif // TS_BOUNDED_QUEUE_H
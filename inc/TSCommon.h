@@ -0,0 +1,57 @@
+#ifndef TS_COMMON_H
+#define TS_COMMON_H
+
+#include <atomic>
+#include <cstddef>
+#include <ranges>
+#include <type_traits>
+
+namespace ts {
+
+#ifndef NO_DISCARD
+#define NO_DISCARD [[nodiscard]]
+#endif
+
+namespace detail {
+
+// Fixed rather than std::hardware_destructive_interference_size so the layout
+// does not change between compilers (GCC warns when that constant is used in headers).
+inline constexpr std::size_t cache_line_size = 64;
+
+inline constexpr std::size_t round_up_pow2(std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Small dense per-thread number, handed out round-robin on a thread's first call.
+// Used to spread threads over shards / slots without hashing std::thread::id.
+inline std::size_t thread_slot() {
+    static std::atomic<std::size_t> next_slot{0};
+    thread_local std::size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+// Elements of an rvalue container can be moved out; views and lvalues only lend their elements.
+template <class R>
+inline constexpr bool owns_movable_elements_v =
+    !std::is_lvalue_reference_v<R> && !std::ranges::view<std::remove_cvref_t<R>>;
+
+// Drives a snapshot_into(): `try_copy()` runs under the container's lock and returns 0 once it
+// has copied into `out`, or the capacity it needs. The buffer then grows here, outside the
+// lock, and the copy is retried.
+template <class Buffer, class TryCopy>
+void copy_into_reused(Buffer& out, TryCopy try_copy) {
+    while (std::size_t needed = try_copy()) {
+        out.clear();
+        out.reserve(needed > out.capacity() * 2 ? needed : out.capacity() * 2);
+    }
+}
+
+} // namespace detail
+
+} // namespace ts
+
+#endif // TS_COMMON_H
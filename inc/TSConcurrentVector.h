@@ -0,0 +1,310 @@
+#ifndef TS_CONCURRENT_VECTOR_H
+#define TS_CONCURRENT_VECTOR_H
+
+#include "TSCommon.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <ranges>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ts {
+
+/**
+ * @brief Append-only vector whose elements never move.
+ *
+ * Storage is a fixed table of exponentially growing segments (32, 32, 64, 128, ...
+ * elements), so growing never copies or relocates existing elements. References, pointers
+ * and indices stay valid for the lifetime of the container.
+ *
+ * An append reserves its index with a CAS on the size and constructs the element in place
+ * without any lock. The segments of a reserved run are allocated before the CAS publishes it
+ * (the first thread to need a segment installs it with a CAS), so every index below size()
+ * has storage. Each element has a state flag, published after construction (or after it
+ * failed), so readers can index concurrently with appends:
+ *
+ *  - operator[](i) requires that the append of `i` happened before (e.g. the index came from push_back).
+ *  - at(i) accepts any i < size() and waits for a concurrent append of `i` to finish.
+ *
+ * size() counts reserved indices, so it may include elements still under construction.
+ * Elements cannot be erased; the container is for growing shared logs, registries and tables.
+ */
+template <typename T>
+class concurrent_vector {
+public:
+    concurrent_vector() = default;
+
+    concurrent_vector(const concurrent_vector&) = delete;
+    concurrent_vector& operator=(const concurrent_vector&) = delete;
+
+    ~concurrent_vector() {
+        for (size_t k = 0; k < max_segments; ++k) {
+            slot* segment = segments_[k].load(std::memory_order_acquire);
+            if (segment == nullptr) {
+                continue;
+            }
+            for (size_t i = 0; i < segment_size(k); ++i) {
+                if (segment[i].state.load(std::memory_order_relaxed) == slot_ready) {
+                    segment[i].get()->~T();
+                }
+            }
+            ::operator delete(segment, std::align_val_t{alignof(slot)});
+        }
+    }
+
+    /**
+     * @brief Number of reserved indices, including appends that are still constructing their element.
+     */
+    NO_DISCARD size_t size() const {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    NO_DISCARD bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Appends a copy of `value` and returns its index.
+     */
+    size_t push_back(const T& value) {
+        size_t index = reserve_indices(1);
+        construct(index, value);
+        return index;
+    }
+
+    size_t push_back(T&& value) {
+        size_t index = reserve_indices(1);
+        construct(index, std::move(value));
+        return index;
+    }
+
+    /**
+     * @brief Constructs an element at the end and returns a reference to it.
+     *
+     * The reference stays valid until the container is destroyed, whatever other threads append.
+     */
+    template <class... Args>
+    T& emplace_back(Args&&... args) {
+        size_t index = reserve_indices(1);
+        return construct(index, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Appends every element of a sized range as one contiguous run of indices.
+     *
+     * Reserves all indices at once and returns the first one. Elements of an rvalue container
+     * are moved; lvalues and views are copied. If an element's construction (or the range
+     * itself) throws, that element and the rest of the run are marked failed, so readers skip
+     * them, and the exception propagates.
+     */
+    template <std::ranges::sized_range R>
+    size_t append_range(R&& range) {
+        size_t count = static_cast<size_t>(std::ranges::size(range));
+        size_t first = reserve_indices(count);
+        size_t index = first;
+        try {
+            for (auto&& element : range) {
+                if constexpr (detail::owns_movable_elements_v<R&&>) {
+                    construct(index, std::move(element));
+                } else {
+                    construct(index, element);
+                }
+                ++index;
+            }
+        } catch (...) {
+            for (; index < first + count; ++index) {
+                slot_at(index).state.store(slot_failed, std::memory_order_release);
+            }
+            throw;
+        }
+        return first;
+    }
+
+    /**
+     * @brief Allocates the segments needed for `count` elements up front.
+     */
+    void reserve(size_t count) {
+        if (count == 0) {
+            return;
+        }
+        for (size_t k = 0; k <= std::min(segment_of(count - 1), max_segments - 1); ++k) {
+            segment(k);
+        }
+    }
+
+    /**
+     * @brief Element `index`, whose append must have completed before this call.
+     */
+    NO_DISCARD T& operator[](size_t index) {
+        return *slot_at(index).get();
+    }
+
+    NO_DISCARD const T& operator[](size_t index) const {
+        return *slot_at(index).get();
+    }
+
+    /**
+     * @brief Bounds-checked access that waits for a concurrent append of `index` to finish.
+     *
+     * Throws std::out_of_range if `index` was never reserved, or if constructing it threw.
+     */
+    NO_DISCARD T& at(size_t index) {
+        return *wait_ready(index).get();
+    }
+
+    NO_DISCARD const T& at(size_t index) const {
+        return *wait_ready(index).get();
+    }
+
+    /**
+     * @brief Calls `callback(element)` for every element appended so far, in index order.
+     *
+     * Waits for appends that are still in flight; elements whose construction threw are skipped.
+     */
+    template <typename F>
+    void for_each(F&& callback) const {
+        size_t count = size();
+        for (size_t i = 0; i < count; ++i) {
+            slot& s = slot_at(i);
+            if (wait_constructed(s) == slot_ready) {
+                callback(std::as_const(*s.get()));
+            }
+        }
+    }
+
+    NO_DISCARD std::vector<T> snapshot() const {
+        std::vector<T> result;
+        result.reserve(size());
+        for_each([&](const T& element) { result.push_back(element); });
+        return result;
+    }
+
+private:
+    static constexpr size_t first_segment_shift = 5;
+    static constexpr size_t first_segment_size = size_t{1} << first_segment_shift;
+    static constexpr size_t max_segments = std::numeric_limits<size_t>::digits - first_segment_shift;
+    // Number of elements held by all segments together.
+    static constexpr size_t max_elements = first_segment_size << (max_segments - 1);
+
+    enum : std::uint8_t { slot_empty, slot_ready, slot_failed };
+
+    struct slot {
+        T* get() {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+
+        alignas(T) unsigned char storage[sizeof(T)];
+        std::atomic<std::uint8_t> state{slot_empty};
+    };
+
+    // Segment 0 and 1 hold 32 elements each, every further segment doubles.
+    static size_t segment_of(size_t index) {
+        return static_cast<size_t>(std::bit_width(index >> first_segment_shift));
+    }
+
+    // Index of the first element of segment k, i.e. the number of elements held by segments [0, k).
+    static size_t segment_start(size_t k) {
+        return k == 0 ? 0 : first_segment_size << (k - 1);
+    }
+
+    static size_t segment_size(size_t k) {
+        return k == 0 ? first_segment_size : first_segment_size << (k - 1);
+    }
+
+    // Claims [first, first + count) and returns `first`. Nothing is published if this throws:
+    // the limit is checked and the run's segments are allocated before the CAS moves size_, so
+    // readers never see an index past the last segment or one without storage.
+    size_t reserve_indices(size_t count) {
+        size_t first = size_.load(std::memory_order_relaxed);
+        for (;;) {
+            if (count > max_elements - first) {
+                throw std::length_error("ts::concurrent_vector: too many elements");
+            }
+            if (count != 0) {
+                for (size_t k = segment_of(first); k <= segment_of(first + count - 1); ++k) {
+                    segment(k);
+                }
+            }
+            if (size_.compare_exchange_weak(first, first + count, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+                return first;
+            }
+        }
+    }
+
+    // Returns segment k, allocating it if this is the first thread to need it.
+    // Readers may allocate too: a reserved index's segment can still be missing while its append runs.
+    slot* segment(size_t k) const {
+        slot* existing = segments_[k].load(std::memory_order_acquire);
+        if (existing != nullptr) {
+            return existing;
+        }
+
+        size_t count = segment_size(k);
+        auto* fresh = static_cast<slot*>(::operator new(count * sizeof(slot), std::align_val_t{alignof(slot)}));
+        for (size_t i = 0; i < count; ++i) {
+            ::new (&fresh[i]) slot;
+        }
+
+        if (segments_[k].compare_exchange_strong(existing, fresh, std::memory_order_acq_rel)) {
+            return fresh;
+        }
+        // Another thread installed the segment first.
+        ::operator delete(fresh, std::align_val_t{alignof(slot)});
+        return existing;
+    }
+
+    slot& slot_at(size_t index) const {
+        size_t k = segment_of(index);
+        return segment(k)[index - segment_start(k)];
+    }
+
+    // `index` must be reserved, so its segment exists and slot_at() cannot throw.
+    template <class... Args>
+    T& construct(size_t index, Args&&... args) {
+        slot& s = slot_at(index);
+        try {
+            ::new (s.storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            s.state.store(slot_failed, std::memory_order_release);
+            throw;
+        }
+        s.state.store(slot_ready, std::memory_order_release);
+        return *s.get();
+    }
+
+    static std::uint8_t wait_constructed(const slot& s) {
+        std::uint8_t state;
+        while ((state = s.state.load(std::memory_order_acquire)) == slot_empty) {
+            std::this_thread::yield();
+        }
+        return state;
+    }
+
+    slot& wait_ready(size_t index) const {
+        if (index >= size()) {
+            throw std::out_of_range("ts::concurrent_vector::at");
+        }
+        slot& s = slot_at(index);
+        if (wait_constructed(s) != slot_ready) {
+            throw std::out_of_range("ts::concurrent_vector::at: element construction failed");
+        }
+        return s;
+    }
+
+    mutable std::array<std::atomic<slot*>, max_segments> segments_{};
+    alignas(detail::cache_line_size) std::atomic<size_t> size_{0};
+};
+
+} // namespace ts
+
+#endif // TS_CONCURRENT_VECTOR_H
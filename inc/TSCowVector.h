@@ -0,0 +1,193 @@
+#ifndef TS_COW_VECTOR_H
+#define TS_COW_VECTOR_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <initializer_list>
+#include <algorithm>
+#include <ranges>
+#include <utility>
+
+#include "TSCommon.h"
+#include "TSFilter.h"
+#include "TSLock.h"
+
+namespace ts {
+
+/**
+ * @brief Copy-on-write vector whose snapshots are O(1) immutable handles.
+ *
+ * The elements live in a std::vector owned through a shared_ptr. snapshot() just copies
+ * that pointer under the lock, so taking a snapshot costs the same for 10 elements as for
+ * a million and never stalls writers for a copy. A writer mutates the current buffer in
+ * place while nobody else holds it, and clones it first if a snapshot is still alive;
+ * the snapshot keeps seeing exactly the elements it was taken with.
+ *
+ * Best for read-mostly data that is exported often (metrics, configuration). With long-lived
+ * snapshots and frequent writes every write pays for a full copy, so ts::vector is the better
+ * choice there.
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename LockPolicy = std::mutex>
+class cow_vector {
+public:
+    using vector_type = std::vector<T, Allocator>;
+    using allocator_type = Allocator;
+    using lock_type = LockPolicy;
+    using snapshot_type = std::shared_ptr<const vector_type>;
+
+    cow_vector() : data_(std::make_shared<vector_type>()) {}
+
+    explicit cow_vector(const Allocator& alloc) : data_(std::make_shared<vector_type>(alloc)) {}
+
+    explicit cow_vector(vector_type vec) : data_(std::make_shared<vector_type>(std::move(vec))) {}
+
+    cow_vector(std::initializer_list<T> init_list) : data_(std::make_shared<vector_type>(init_list)) {}
+
+    // Copies share the buffer until either side writes.
+    cow_vector(const cow_vector& other) : data_(other.share()) {}
+
+    cow_vector& operator=(const cow_vector& other) {
+        if (this != &other) {
+            std::shared_ptr<vector_type> shared = other.share();
+            std::lock_guard lock(mutex_);
+            data_.swap(shared);
+        }
+        return *this;
+    }
+
+    ~cow_vector() = default;
+
+    /**
+     * @brief Returns an immutable handle to the current contents in O(1).
+     *
+     * The handle stays valid and unchanged however the cow_vector is modified afterwards.
+     */
+    NO_DISCARD snapshot_type snapshot() const {
+        return share();
+    }
+
+    NO_DISCARD size_t size() const {
+        return detail::with_shared_lock(mutex_, [&] { return data_->size(); });
+    }
+
+    NO_DISCARD bool empty() const {
+        return detail::with_shared_lock(mutex_, [&] { return data_->empty(); });
+    }
+
+    /**
+     * @brief Executes a user-provided function on a const view of the current contents.
+     *
+     * Returns whatever the callback returns. For long reads prefer snapshot(), which holds
+     * no lock at all while the data is being looked at.
+     */
+    template <typename F>
+    decltype(auto) read(F&& callback) const {
+        detail::shared_guard<LockPolicy> lock(mutex_);
+        return std::forward<F>(callback)(std::as_const(*data_));
+    }
+
+    void clear() {
+        std::lock_guard lock(mutex_);
+        if (data_.use_count() > 1) {
+            data_ = std::make_shared<vector_type>(data_->get_allocator());
+        } else {
+            writable().clear();
+        }
+    }
+
+    void push_back(const T& value) {
+        std::lock_guard lock(mutex_);
+        writable().push_back(value);
+    }
+
+    void push_back(T&& value) {
+        std::lock_guard lock(mutex_);
+        writable().push_back(std::move(value));
+    }
+
+    /**
+     * @brief Constructs an element at the back.
+     *
+     * Unlike ts::vector this returns nothing: the next write may move the elements to a new buffer.
+     */
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        std::lock_guard lock(mutex_);
+        writable().emplace_back(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Appends every element of `range` with at most one clone of the buffer.
+     *
+     * Elements of an rvalue container are moved; lvalues and views are copied.
+     */
+    template <std::ranges::input_range R>
+    void append_range(R&& range) {
+        std::lock_guard lock(mutex_);
+        vector_type& data = writable();
+        for (auto&& element : range) {
+            if constexpr (detail::owns_movable_elements_v<R&&>) {
+                data.emplace_back(std::move(element));
+            } else {
+                data.emplace_back(element);
+            }
+        }
+    }
+
+    void pop_back() {
+        std::lock_guard lock(mutex_);
+        writable().pop_back();
+    }
+
+    void reserve(size_t size) {
+        std::lock_guard lock(mutex_);
+        writable().reserve(size);
+    }
+
+    template <typename Pred>
+    void erase_if(Pred pred) {
+        std::lock_guard lock(mutex_);
+        vector_type& data = writable();
+        data.erase(detail::filter_remove_if(data.begin(), data.end(), pred), data.end());
+    }
+
+    /**
+     * @brief Executes a user-provided function on the internal vector under an exclusive lock.
+     *
+     * The vector is cloned first if a snapshot still references it, so the callback can never
+     * change what a snapshot sees.
+     *
+     * ⚠️ Do not store references or iterators after this call — they might become invalid when the lock is released.
+     */
+    template <typename F>
+    void process(F&& callback) {
+        std::lock_guard lock(mutex_);
+        std::forward<F>(callback)(writable());
+    }
+
+private:
+    std::shared_ptr<vector_type> share() const {
+        return detail::with_shared_lock(mutex_, [&] { return data_; });
+    }
+
+    // Must hold mutex_ exclusively. New references are only created under the lock, so a
+    // use count of 1 means no snapshot can observe the buffer any more.
+    vector_type& writable() {
+        if (data_.use_count() > 1) {
+            data_ = std::make_shared<vector_type>(*data_);
+        } else {
+            // Pairs with the release decrement of the last snapshot, whose reads must be finished.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *data_;
+    }
+
+    mutable LockPolicy mutex_;
+    std::shared_ptr<vector_type> data_;
+};
+
+} // namespace ts
+
+#endif // TS_COW_VECTOR_H
@@ -1,11 +1,26 @@
 #ifndef TS_DEQUE_H
 #define TS_DEQUE_H
 
+#include <atomic>
 #include <deque>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <chrono>
+#include <coroutine>
 #include <initializer_list>
 #include <algorithm>
 #include <optional>
+#include <vector>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <utility>
+
+#include "TSCommon.h"
+#include "TSLock.h"
+#include "TSLockStats.h"
 
 namespace ts {
 
@@ -13,140 +28,716 @@ namespace ts {
 #define NO_DISCARD [[nodiscard]]
 #endif
 
-template <typename T>
+/**
+ * @brief Mutex-protected std::deque with blocking, timed, bulk and coroutine operations.
+ *
+ * `LockPolicy` is the mutex type guarding the deque (see TSLock.h for the shipped policies).
+ * The default is std::mutex. With std::shared_mutex, const operations (size, empty, read, ...)
+ * run concurrently with each other, which suits read-mostly use sites.
+ *
+ * With ts::flat_combining_mutex, the short element operations (push / emplace / pop at
+ * either end, size, empty, clear) are combined: under contention one thread runs a whole
+ * batch of them while the others wait for their results. Pushes that must wait for room
+ * and the wait_* / try_*_for operations always sleep on a condition variable in the
+ * calling thread.
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename LockPolicy = std::mutex>
 class deque {
+    // LockPolicy itself, or LockPolicy with contention counters under TS_ENABLE_LOCK_STATS.
+    using mutex_type = detail::instrumented_lock_t<LockPolicy>;
+
 public:
+    using deque_type = std::deque<T, Allocator>;
+    using allocator_type = Allocator;
+    using lock_type = LockPolicy;
+
     deque() = default;
 
+    explicit deque(const Allocator& alloc) : data_(alloc) {}
+
     deque(const deque& other) {
-        std::lock_guard<std::mutex> lock1(mutex_, std::defer_lock);
-        std::lock_guard<std::mutex> lock2(other.mutex_, std::defer_lock);
+        TS_LOCK_SITE();
+        std::unique_lock<mutex_type> lock1(mutex_, std::defer_lock);
+        std::unique_lock<mutex_type> lock2(other.mutex_, std::defer_lock);
         std::lock(lock1, lock2);
         data_ = other.data_;
+        max_capacity_ = other.max_capacity_;
     }
 
     deque(deque&& other) noexcept {
-        std::lock_guard<std::mutex> lock1(mutex_, std::defer_lock);
-        std::lock_guard<std::mutex> lock2(other.mutex_, std::defer_lock);
+        TS_LOCK_SITE();
+        std::unique_lock<mutex_type> lock1(mutex_, std::defer_lock);
+        std::unique_lock<mutex_type> lock2(other.mutex_, std::defer_lock);
         std::lock(lock1, lock2);
         data_ = std::move(other.data_);
+        max_capacity_ = other.max_capacity_;
     }
 
     deque(std::initializer_list<T> init) {
-        std::lock_guard<std::mutex> lock(mutex_);
+        TS_LOCK_SITE();
+        std::lock_guard<mutex_type> lock(mutex_);
         data_ = init;
     }
 
     NO_DISCARD deque& operator=(const deque& other) {
+        TS_LOCK_SITE();
         if (this != &other) {
-            std::lock_guard<std::mutex> lock1(mutex_, std::defer_lock);
-            std::lock_guard<std::mutex> lock2(other.mutex_, std::defer_lock);
-            std::lock(lock1, lock2);
-            data_ = other.data_;
+            async_waiter* ready = nullptr;
+            {
+                std::unique_lock<mutex_type> lock1(mutex_, std::defer_lock);
+                std::unique_lock<mutex_type> lock2(other.mutex_, std::defer_lock);
+                std::lock(lock1, lock2);
+                data_ = other.data_;
+                max_capacity_ = other.max_capacity_;
+                ready = claim_async_waiters();
+                not_empty_.notify_all();
+                not_full_.notify_all();
+            }
+            resume_async_waiters(ready);
         }
         return *this;
     }
 
     NO_DISCARD deque& operator=(deque&& other) noexcept {
+        TS_LOCK_SITE();
         if (this != &other) {
-            std::lock_guard<std::mutex> lock1(mutex_, std::defer_lock);
-            std::lock_guard<std::mutex> lock2(other.mutex_, std::defer_lock);
-            std::lock(lock1, lock2);
-            data_ = std::move(other.data_);
+            async_waiter* ready = nullptr;
+            {
+                std::unique_lock<mutex_type> lock1(mutex_, std::defer_lock);
+                std::unique_lock<mutex_type> lock2(other.mutex_, std::defer_lock);
+                std::lock(lock1, lock2);
+                data_ = std::move(other.data_);
+                max_capacity_ = other.max_capacity_;
+                ready = claim_async_waiters();
+                not_empty_.notify_all();
+                not_full_.notify_all();
+            }
+            resume_async_waiters(ready);
         }
         return *this;
     }
 
     ~deque() = default;
 
+    NO_DISCARD allocator_type get_allocator() const {
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] { return data_.get_allocator(); });
+    }
+
     NO_DISCARD bool empty() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return data_.empty();
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] { return data_.empty(); });
     }
 
     NO_DISCARD size_t size() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return data_.size();
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] { return data_.size(); });
     }
 
-    NO_DISCARD std::optional<T> pop_front_nullable() {
-        std::lock_guard<std::mutex> lock(mutex_);
+    /**
+     * @brief Executes a user-provided function on a const view of the internal deque.
+     *
+     * With a shared lock type, any number of read() callbacks (and other const operations)
+     * run at the same time, while writers wait. Returns whatever the callback returns.
+     *
+     * ⚠️ Do not store references or iterators after this call — they might become invalid when the lock is released.
+     */
+    template <typename F>
+    decltype(auto) read(F&& callback) const {
+        TS_LOCK_SITE();
+        detail::shared_guard<mutex_type> lock(mutex_);
+        return std::forward<F>(callback)(std::as_const(data_));
+    }
 
-        if (data_.empty()) {
-            return std::nullopt;
-        }
+    NO_DISCARD std::optional<T> pop_front_nullable() {
+        TS_LOCK_SITE();
+        return detail::with_lock(mutex_, [&]() -> std::optional<T> {
+            if (data_.empty()) {
+                return std::nullopt;
+            }
 
-        T value = std::move(data_.front());
-        data_.pop_front();
-        return value;
+            T value = std::move(data_.front());
+            data_.pop_front();
+            notify_not_full();
+            return value;
+        });
     }
 
     NO_DISCARD std::optional<T> pop_back_nullable() {
-        std::lock_guard<std::mutex> lock(mutex_);
+        TS_LOCK_SITE();
+        return detail::with_lock(mutex_, [&]() -> std::optional<T> {
+            if (data_.empty()) {
+                return std::nullopt;
+            }
 
-        if (data_.empty()) {
-            return std::nullopt;
-        }
-
-        T value = std::move(data_.back());
-        data_.pop_back();
-        return value;
+            T value = std::move(data_.back());
+            data_.pop_back();
+            notify_not_full();
+            return value;
+        });
     }
 
     NO_DISCARD T pop_front() {
-        std::lock_guard<std::mutex> lock(mutex_);
+        TS_LOCK_SITE();
+        return detail::with_lock(mutex_, [&] {
+            T value = std::move(data_.front());
+            data_.pop_front();
+            notify_not_full();
+            return value;
+        });
+    }
+
+    NO_DISCARD T pop_back() {
+        TS_LOCK_SITE();
+        return detail::with_lock(mutex_, [&] {
+            T value = std::move(data_.back());
+            data_.pop_back();
+            notify_not_full();
+            return value;
+        });
+    }
+
+    /**
+     * @brief Removes and returns the front element, blocking until one is available.
+     *
+     * The calling thread sleeps on a condition variable instead of spinning on empty(),
+     * so it does not hold or contend for the lock while waiting.
+     */
+    NO_DISCARD T wait_pop_front() {
+        TS_LOCK_SITE();
+        std::unique_lock<mutex_type> lock(mutex_);
+        wait_not_empty(lock);
+
         T value = std::move(data_.front());
         data_.pop_front();
+        notify_not_full();
         return value;
     }
 
-    NO_DISCARD T pop_back() {
-        std::lock_guard<std::mutex> lock(mutex_);
+    /**
+     * @brief Removes and returns the back element, blocking until one is available.
+     */
+    NO_DISCARD T wait_pop_back() {
+        TS_LOCK_SITE();
+        std::unique_lock<mutex_type> lock(mutex_);
+        wait_not_empty(lock);
+
         T value = std::move(data_.back());
         data_.pop_back();
+        notify_not_full();
+        return value;
+    }
+
+    /**
+     * @brief Removes and returns the front element, waiting at most `timeout` for one to arrive.
+     *
+     * Returns std::nullopt if the deque is still empty when the timeout expires.
+     */
+    template <class Rep, class Period>
+    NO_DISCARD std::optional<T> try_pop_for(const std::chrono::duration<Rep, Period>& timeout) {
+        return try_pop_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    /**
+     * @brief Removes and returns the front element, waiting until `deadline` for one to arrive.
+     *
+     * Returns std::nullopt if the deque is still empty at the deadline.
+     */
+    template <class Clock, class Duration>
+    NO_DISCARD std::optional<T> try_pop_until(const std::chrono::time_point<Clock, Duration>& deadline) {
+        TS_LOCK_SITE();
+        std::unique_lock<mutex_type> lock(mutex_);
+
+        ++sleeping_consumers_;
+        bool ready = not_empty_.wait_until(lock, deadline, [this] { return !data_.empty(); });
+        --sleeping_consumers_;
+        if (!ready) {
+            return std::nullopt;
+        }
+
+        T value = std::move(data_.front());
+        data_.pop_front();
+        notify_not_full();
         return value;
     }
 
     void push_front(const T& value) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        data_.push_front(value);
+        TS_LOCK_SITE();
+        locked_push([&] { data_.push_front(value); });
     }
 
     void push_front(T&& value) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        data_.push_front(std::move(value));
+        TS_LOCK_SITE();
+        locked_push([&] { data_.push_front(std::move(value)); });
     }
 
+    /**
+     * @brief Appends an element to the back.
+     *
+     * If a max capacity is set and the deque is full, blocks until a consumer makes room.
+     */
     void push_back(const T& value) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        data_.push_back(value);
+        TS_LOCK_SITE();
+        locked_push([&] { data_.push_back(value); });
     }
 
     void push_back(T&& value) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        data_.push_back(std::move(value));
+        TS_LOCK_SITE();
+        locked_push([&] { data_.push_back(std::move(value)); });
+    }
+
+    /**
+     * @brief Appends an element to the back, waiting at most `timeout` for room.
+     *
+     * Returns false (and leaves `value` untouched) if the deque is still full when the timeout expires.
+     * Without a max capacity this never waits.
+     */
+    template <class U, class Rep, class Period>
+    NO_DISCARD bool try_push_back_for(U&& value, const std::chrono::duration<Rep, Period>& timeout) {
+        return try_push_back_until(std::forward<U>(value), std::chrono::steady_clock::now() + timeout);
+    }
+
+    /**
+     * @brief Appends an element to the back, waiting until `deadline` for room.
+     *
+     * Returns false (and leaves `value` untouched) if the deque is still full at the deadline.
+     */
+    template <class U, class Clock, class Duration>
+    NO_DISCARD bool try_push_back_until(U&& value, const std::chrono::time_point<Clock, Duration>& deadline) {
+        TS_LOCK_SITE();
+        std::unique_lock<mutex_type> lock(mutex_);
+
+        if (!not_full_.wait_until(lock, deadline, [this] { return !full(); })) {
+            return false;
+        }
+
+        data_.push_back(std::forward<U>(value));
+        wake_consumers(lock);
+        return true;
     }
 
     template <class... Args>
     void emplace_front(Args&&... args) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        data_.emplace_front(std::forward<Args>(args)...);
+        TS_LOCK_SITE();
+        locked_push([&] { data_.emplace_front(std::forward<Args>(args)...); });
     }
 
     template <class... Args>
     void emplace_back(Args&&... args) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        data_.emplace_back(std::forward<Args>(args)...);
+        TS_LOCK_SITE();
+        locked_push([&] { data_.emplace_back(std::forward<Args>(args)...); });
     }
 
-    void clear() {
-        std::lock_guard<std::mutex> lock(mutex_);
+    /**
+     * @brief Appends [first, last) to the back under a single lock acquisition.
+     *
+     * With a max capacity set, waiting consumers are woken and the call blocks
+     * whenever the deque fills up part-way through the range.
+     * Pass std::make_move_iterator iterators to move the elements instead of copying them.
+     */
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    void push_back_range(InputIt first, Sentinel last) {
+        TS_LOCK_SITE();
+        std::unique_lock<mutex_type> lock(mutex_);
+        bool pushed = false;
+        for (; first != last; ++first) {
+            wait_not_full_bulk(lock, pushed);
+            data_.emplace_back(*first);
+            pushed = true;
+        }
+        if (pushed) {
+            wake_consumers(lock, true);
+        }
+    }
+
+    /**
+     * @brief Appends every element of `range` to the back under a single lock acquisition.
+     *
+     * Elements of an rvalue container are moved; lvalues and views are copied.
+     */
+    template <std::ranges::input_range R>
+    void append_range(R&& range) {
+        TS_LOCK_SITE();
+        std::unique_lock<mutex_type> lock(mutex_);
+        bool pushed = false;
+        for (auto&& element : range) {
+            wait_not_full_bulk(lock, pushed);
+            if constexpr (detail::owns_movable_elements_v<R&&>) {
+                data_.emplace_back(std::move(element));
+            } else {
+                data_.emplace_back(element);
+            }
+            pushed = true;
+        }
+        if (pushed) {
+            wake_consumers(lock, true);
+        }
+    }
+
+    /**
+     * @brief Moves up to `count` elements from the front into `out` under a single lock acquisition.
+     *
+     * Returns the number of elements popped, which is less than `count` if the deque runs empty.
+     */
+    template <std::output_iterator<T&&> OutputIt>
+    size_t pop_front_bulk(size_t count, OutputIt out) {
+        TS_LOCK_SITE();
+        std::lock_guard<mutex_type> lock(mutex_);
+        count = std::min(count, data_.size());
+
+        auto end = data_.begin() + static_cast<std::ptrdiff_t>(count);
+        std::move(data_.begin(), end, out);
+        data_.erase(data_.begin(), end);
+
+        if (count != 0 && max_capacity_ != 0) {
+            not_full_.notify_all();
+        }
+        return count;
+    }
+
+    /**
+     * @brief Moves every element to the back of `out` and leaves the deque empty.
+     *
+     * `out` is grown once before the elements are moved. Returns the number of elements drained.
+     */
+    template <typename OutAllocator>
+    size_t drain_into(std::vector<T, OutAllocator>& out) {
+        TS_LOCK_SITE();
+        std::lock_guard<mutex_type> lock(mutex_);
+        size_t count = data_.size();
+
+        out.reserve(out.size() + count);
+        std::move(data_.begin(), data_.end(), std::back_inserter(out));
         data_.clear();
+
+        if (count != 0 && max_capacity_ != 0) {
+            not_full_.notify_all();
+        }
+        return count;
+    }
+
+    /**
+     * @brief Copies the contents into `out`, reusing its capacity.
+     *
+     * Like ts::vector::snapshot_into(), `out` is grown with the lock released, so steady-state
+     * polling with the same buffer allocates nothing.
+     */
+    template <typename OutAllocator>
+    void snapshot_into(std::vector<T, OutAllocator>& out) const {
+        TS_LOCK_SITE();
+        detail::copy_into_reused(out, [&] {
+            return detail::with_shared_lock(mutex_, [&]() -> size_t {
+                if (data_.size() > out.capacity()) {
+                    return data_.size();
+                }
+                out.assign(data_.begin(), data_.end());
+                return 0;
+            });
+        });
+    }
+
+    /**
+     * @brief Copies up to `out.size()` elements from the front into a fixed buffer and returns the deque's size.
+     *
+     * A result larger than `out.size()` means the copy was truncated (like snprintf).
+     */
+    size_t snapshot_into(std::span<T> out) const {
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] {
+            std::copy_n(data_.begin(), std::min(out.size(), data_.size()), out.begin());
+            return data_.size();
+        });
+    }
+
+private:
+    struct async_waiter {
+        async_waiter* next = nullptr;
+        std::optional<T> result;
+        std::coroutine_handle<> handle;
+        void (*dispatch)(async_waiter*) = nullptr;
+        // Linked into async_head_; set and cleared under mutex_.
+        std::atomic<bool> queued{false};
+    };
+
+    template <class Executor>
+    class pop_front_awaiter_on : private async_waiter {
+    public:
+        pop_front_awaiter_on(deque& owner, Executor executor)
+            : owner_(owner), executor_(std::move(executor)) {
+            this->dispatch = [](async_waiter* waiter) {
+                auto* self = static_cast<pop_front_awaiter_on*>(waiter);
+                self->executor_(self->handle);
+            };
+        }
+
+        pop_front_awaiter_on(const pop_front_awaiter_on&) = delete;
+        pop_front_awaiter_on& operator=(const pop_front_awaiter_on&) = delete;
+
+        // Destroying a suspended coroutine destroys its awaiter; a queued one must leave the list.
+        ~pop_front_awaiter_on() {
+            if (this->queued.load(std::memory_order_acquire)) {
+                std::lock_guard<mutex_type> lock(owner_.mutex_);
+                owner_.cancel_async_waiter(this);
+            }
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            TS_LOCK_SITE();
+            this->handle = handle;
+            std::unique_lock<mutex_type> lock(owner_.mutex_);
+
+            if (!owner_.data_.empty()) {
+                this->result.emplace(std::move(owner_.data_.front()));
+                owner_.data_.pop_front();
+                owner_.notify_not_full();
+                return false;
+            }
+
+            owner_.enqueue_async_waiter(this);
+            return true;
+        }
+
+        T await_resume() {
+            return std::move(*this->result);
+        }
+
+    private:
+        deque& owner_;
+        Executor executor_;
+    };
+
+    using inline_executor = void (*)(std::coroutine_handle<>);
+
+public:
+    using pop_front_awaiter = pop_front_awaiter_on<inline_executor>;
+
+    /**
+     * @brief Returns an awaitable that pops the front element without blocking a thread.
+     *
+     *     T value = co_await dq.async_pop_front();
+     *
+     * If the deque is empty, the coroutine is suspended and queued as a waiter. The next push
+     * hands its element straight to the longest-waiting coroutine and resumes it on the pushing
+     * thread, after the lock has been released. Suspended coroutines are served before threads
+     * blocked in wait_pop_front(). The deque must outlive every pending awaiter.
+     *
+     * A suspended coroutine may be destroyed (cancelled) while it is still queued: its waiter
+     * leaves the queue and the element goes to the next waiter. Destroying it concurrently with
+     * a push that might serve it is a race, as with any coroutine another thread may resume.
+     */
+    NO_DISCARD pop_front_awaiter async_pop_front() {
+        return pop_front_awaiter(*this, [](std::coroutine_handle<> handle) { handle.resume(); });
+    }
+
+    /**
+     * @brief Like async_pop_front(), but a suspended coroutine is resumed by calling
+     * `executor(handle)` instead of inline on the pushing thread.
+     *
+     * `executor` must be copyable and invocable with a std::coroutine_handle<>; it is stored
+     * in the awaiter, so no allocation takes place.
+     */
+    template <class Executor>
+    NO_DISCARD auto async_pop_front(Executor executor) {
+        return pop_front_awaiter_on<Executor>(*this, std::move(executor));
+    }
+
+    void clear() {
+        TS_LOCK_SITE();
+        detail::with_lock(mutex_, [&] {
+            data_.clear();
+            not_full_.notify_all();
+        });
+    }
+
+    /**
+     * @brief Limits the number of elements the deque may hold; 0 (the default) means unbounded.
+     *
+     * While the deque is at capacity, push_back / push_front / emplace_* block and
+     * try_push_back_for / try_push_back_until time out, giving producers backpressure.
+     * Lowering the capacity never drops elements that are already stored.
+     */
+    void set_max_capacity(size_t max_capacity) {
+        TS_LOCK_SITE();
+        std::lock_guard<mutex_type> lock(mutex_);
+        max_capacity_ = max_capacity;
+        not_full_.notify_all();
+    }
+
+    NO_DISCARD size_t max_capacity() const {
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] { return max_capacity_; });
+    }
+
+    /**
+     * @brief Contention and hold-time counters of this deque's lock (see TSLockStats.h).
+     *
+     * All zero unless the program is built with TS_ENABLE_LOCK_STATS.
+     */
+    NO_DISCARD lock_stats stats() const {
+        return detail::lock_stats_of(mutex_);
+    }
+
+    /**
+     * @brief Names this deque in lock_registry dumps. No-op without TS_ENABLE_LOCK_STATS.
+     */
+    void set_stats_label(std::string label) {
+        detail::set_lock_stats_label(mutex_, std::move(label));
     }
 
 private:
-    mutable std::mutex mutex_;
-    std::deque<T> data_;
+    // Runs `push` in one critical section (combined when the lock supports it) unless the deque is
+    // full, in which case it falls back to sleeping on not_full_. `push` runs exactly once.
+    template <class Push>
+    void locked_push(Push&& push) {
+        async_waiter* ready = nullptr;
+        bool pushed = detail::with_lock(mutex_, [&] {
+            if (full()) {
+                return false;
+            }
+            push();
+            ready = claim_async_waiters();
+            notify_not_empty();
+            return true;
+        });
+
+        if (!pushed) {
+            std::unique_lock<mutex_type> lock(mutex_);
+            wait_not_full(lock);
+            push();
+            wake_consumers(lock);
+            return;
+        }
+        resume_async_waiters(ready);
+    }
+
+    // Serves suspended coroutines first, then wakes threads blocked on not_empty_.
+    void wake_consumers(std::unique_lock<mutex_type>& lock, bool wake_all = false) {
+        async_waiter* ready = claim_async_waiters();
+        if (wake_all) {
+            if (sleeping_consumers_ != 0) {
+                not_empty_.notify_all();
+            }
+        } else {
+            notify_not_empty();
+        }
+
+        if (ready != nullptr) {
+            lock.unlock();
+            resume_async_waiters(ready);
+        }
+    }
+
+    void enqueue_async_waiter(async_waiter* waiter) {
+        if (async_tail_ == nullptr) {
+            async_head_ = waiter;
+        } else {
+            async_tail_->next = waiter;
+        }
+        async_tail_ = waiter;
+        waiter->queued.store(true, std::memory_order_relaxed);
+    }
+
+    // Unlinks a waiter whose coroutine is being destroyed. Must hold mutex_.
+    void cancel_async_waiter(async_waiter* waiter) {
+        if (!waiter->queued.load(std::memory_order_relaxed)) {
+            return;
+        }
+        async_waiter* previous = nullptr;
+        for (async_waiter* current = async_head_; current != waiter; current = current->next) {
+            previous = current;
+        }
+        (previous == nullptr ? async_head_ : previous->next) = waiter->next;
+        if (async_tail_ == waiter) {
+            async_tail_ = previous;
+        }
+        waiter->queued.store(false, std::memory_order_relaxed);
+    }
+
+    // Moves one element into each waiting coroutine, in arrival order. Must hold mutex_.
+    async_waiter* claim_async_waiters() {
+        async_waiter* ready = nullptr;
+        async_waiter** ready_tail = &ready;
+
+        while (async_head_ != nullptr && !data_.empty()) {
+            async_waiter* waiter = async_head_;
+            async_head_ = waiter->next;
+            if (async_head_ == nullptr) {
+                async_tail_ = nullptr;
+            }
+
+            waiter->result.emplace(std::move(data_.front()));
+            data_.pop_front();
+            notify_not_full();
+
+            waiter->queued.store(false, std::memory_order_release);
+            waiter->next = nullptr;
+            *ready_tail = waiter;
+            ready_tail = &waiter->next;
+        }
+        return ready;
+    }
+
+    // Must be called without holding mutex_: a resumed coroutine may use the deque again.
+    static void resume_async_waiters(async_waiter* ready) {
+        while (ready != nullptr) {
+            async_waiter* next = ready->next;
+            ready->dispatch(ready);
+            ready = next;
+        }
+    }
+
+    bool full() const {
+        return max_capacity_ != 0 && data_.size() >= max_capacity_;
+    }
+
+    void wait_not_full(std::unique_lock<mutex_type>& lock) {
+        not_full_.wait(lock, [this] { return !full(); });
+    }
+
+    // Hands what has been pushed so far to consumers before sleeping, so they can make room.
+    void wait_not_full_bulk(std::unique_lock<mutex_type>& lock, bool pushed) {
+        if (full() && pushed) {
+            if (async_waiter* ready = claim_async_waiters()) {
+                lock.unlock();
+                resume_async_waiters(ready);
+                lock.lock();
+            }
+            not_empty_.notify_all();
+        }
+        wait_not_full(lock);
+    }
+
+    void wait_not_empty(std::unique_lock<mutex_type>& lock) {
+        ++sleeping_consumers_;
+        not_empty_.wait(lock, [this] { return !data_.empty(); });
+        --sleeping_consumers_;
+    }
+
+    // Skips the notify (which locks an internal mutex for condition_variable_any) when nobody sleeps.
+    void notify_not_empty() {
+        if (sleeping_consumers_ != 0 && !data_.empty()) {
+            not_empty_.notify_one();
+        }
+    }
+
+    void notify_not_full() {
+        if (max_capacity_ != 0) {
+            not_full_.notify_one();
+        }
+    }
+
+    mutable mutex_type mutex_;
+    detail::condition_variable_for<mutex_type> not_empty_;
+    detail::condition_variable_for<mutex_type> not_full_;
+    size_t max_capacity_ = 0;
+    size_t sleeping_consumers_ = 0;
+    async_waiter* async_head_ = nullptr;
+    async_waiter* async_tail_ = nullptr;
+    deque_type data_;
 };
 
 } // namespace ts
@@ -0,0 +1,207 @@
+#ifndef TS_EPOCH_H
+#define TS_EPOCH_H
+
+#include "TSCommon.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace ts {
+
+namespace detail {
+
+/**
+ * @brief Process-wide epoch-based reclamation (EBR) domain.
+ *
+ * Readers bracket every access to shared, lock-free published memory with an epoch_guard.
+ * Entering announces the current global epoch in the thread's own record (its own cache
+ * line, so readers never write to memory another reader writes). Writers unlink an object
+ * and retire() it; the object is deleted only once the global epoch has advanced twice
+ * past the retirement, which guarantees that every reader that could still see it has left.
+ *
+ * The epoch advances when every active reader has announced the current one. A reader
+ * that stays inside a guard forever therefore stalls reclamation (memory grows) but never
+ * causes a use-after-free. Like pool_arena, the domain is intentionally leaked.
+ */
+class epoch_domain {
+public:
+    static epoch_domain& instance() {
+        static epoch_domain* domain = new epoch_domain;
+        return *domain;
+    }
+
+    void enter() noexcept {
+        local_state& local = local_record();
+        if (local.depth++ == 0) {
+            local.record->state.store((global_epoch_.load(std::memory_order_relaxed) << 1) | 1,
+                                      std::memory_order_relaxed);
+            // The announcement must be visible before any protected pointer is loaded.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void leave() noexcept {
+        local_state& local = local_record();
+        if (--local.depth == 0) {
+            local.record->state.store(0, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Schedules `deleter(pointer)` for when no reader can still hold `pointer`.
+     *
+     * `pointer` must already be unreachable for new readers.
+     */
+    void retire(void* pointer, void (*deleter)(void*)) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::vector<retired> ready;
+        {
+            std::lock_guard lock(retired_mutex_);
+            retired_.push_back({pointer, deleter, global_epoch_.load(std::memory_order_relaxed)});
+            collect(ready);
+        }
+        for (const retired& item : ready) {
+            item.deleter(item.pointer);
+        }
+    }
+
+    /**
+     * @brief Tries to advance the epoch and frees whatever has become safe. Returns how many objects were freed.
+     */
+    size_t reclaim() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::vector<retired> ready;
+        {
+            std::lock_guard lock(retired_mutex_);
+            // Two advances are needed before the newest retirement becomes safe.
+            try_advance();
+            collect(ready);
+        }
+        for (const retired& item : ready) {
+            item.deleter(item.pointer);
+        }
+        return ready.size();
+    }
+
+private:
+    struct alignas(cache_line_size) thread_record {
+        // 0 while outside any guard, otherwise (announced epoch << 1) | 1.
+        std::atomic<std::uint64_t> state{0};
+        std::atomic<bool> in_use{true};
+        thread_record* next = nullptr;
+    };
+
+    struct local_state {
+        ~local_state() {
+            if (record != nullptr) {
+                record->state.store(0, std::memory_order_release);
+                record->in_use.store(false, std::memory_order_release);
+            }
+        }
+
+        thread_record* record = nullptr;
+        unsigned depth = 0;
+    };
+
+    struct retired {
+        void* pointer;
+        void (*deleter)(void*);
+        std::uint64_t epoch;
+    };
+
+    local_state& local_record() {
+        thread_local local_state local;
+        if (local.record == nullptr) {
+            local.record = acquire_record();
+        }
+        return local;
+    }
+
+    // Records of exited threads are reused; the list itself only ever grows.
+    thread_record* acquire_record() {
+        for (thread_record* record = records_.load(std::memory_order_acquire); record != nullptr;
+             record = record->next) {
+            bool expected = false;
+            if (!record->in_use.load(std::memory_order_relaxed) &&
+                record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return record;
+            }
+        }
+
+        auto* record = new thread_record;
+        record->next = records_.load(std::memory_order_relaxed);
+        while (!records_.compare_exchange_weak(record->next, record, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+        }
+        return record;
+    }
+
+    // Advances the global epoch if no active reader is still in an older one. Must hold retired_mutex_.
+    bool try_advance() {
+        std::uint64_t current = global_epoch_.load(std::memory_order_relaxed);
+        for (thread_record* record = records_.load(std::memory_order_acquire); record != nullptr;
+             record = record->next) {
+            std::uint64_t state = record->state.load(std::memory_order_acquire);
+            if ((state & 1) != 0 && (state >> 1) != current) {
+                return false;
+            }
+        }
+        global_epoch_.store(current + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Moves every retirement that is two epochs old into `ready`. Must hold retired_mutex_.
+    // Retirements are appended under the same mutex that advances the epoch, so the queue is
+    // ordered by epoch and only its ready prefix is ever looked at.
+    void collect(std::vector<retired>& ready) {
+        if (try_advance()) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        std::uint64_t current = global_epoch_.load(std::memory_order_relaxed);
+        while (!retired_.empty() && retired_.front().epoch + 2 <= current) {
+            ready.push_back(retired_.front());
+            retired_.pop_front();
+        }
+    }
+
+    alignas(cache_line_size) std::atomic<std::uint64_t> global_epoch_{0};
+    std::atomic<thread_record*> records_{nullptr};
+
+    std::mutex retired_mutex_;
+    std::deque<retired> retired_;
+};
+
+/**
+ * @brief RAII read-side critical section of the epoch domain. Guards may nest.
+ */
+class epoch_guard {
+public:
+    epoch_guard() noexcept {
+        epoch_domain::instance().enter();
+    }
+
+    ~epoch_guard() {
+        epoch_domain::instance().leave();
+    }
+
+    epoch_guard(const epoch_guard&) = delete;
+    epoch_guard& operator=(const epoch_guard&) = delete;
+};
+
+// Retires an object allocated with `new T`.
+template <typename T>
+void retire_delete(T* pointer) {
+    epoch_domain::instance().retire(const_cast<void*>(static_cast<const void*>(pointer)), [](void* retired) {
+        delete static_cast<T*>(retired);
+    });
+}
+
+} // namespace detail
+
+} // namespace ts
+
+#endif // TS_EPOCH_H
@@ -0,0 +1,525 @@
+#ifndef TS_FILTER_H
+#define TS_FILTER_H
+
+#include "TSCommon.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TS_FILTER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ts {
+
+namespace detail {
+
+enum class filter_op { less, less_equal, greater, greater_equal, equal_to, not_equal_to, in_range, any_bits };
+
+// Evaluates `op` on x. Arithmetic operands are compared in their common type, exactly like the
+// built-in operators, but without signed/unsigned comparison warnings at the call site.
+template <filter_op Op, class U, class V>
+constexpr bool filter_apply(const U& x, const V& a, const V& b) {
+    if constexpr (std::is_arithmetic_v<U> && std::is_arithmetic_v<V> && !std::is_same_v<U, V>) {
+        using C = std::common_type_t<U, V>;
+        return filter_apply<Op>(static_cast<C>(x), static_cast<C>(a), static_cast<C>(b));
+    } else if constexpr (Op == filter_op::less) {
+        return x < a;
+    } else if constexpr (Op == filter_op::less_equal) {
+        return x <= a;
+    } else if constexpr (Op == filter_op::greater) {
+        return x > a;
+    } else if constexpr (Op == filter_op::greater_equal) {
+        return x >= a;
+    } else if constexpr (Op == filter_op::equal_to) {
+        return x == a;
+    } else if constexpr (Op == filter_op::not_equal_to) {
+        return x != a;
+    } else if constexpr (Op == filter_op::in_range) {
+        return a <= x && x < b;
+    } else {
+        return (x & a) != 0;
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Predicate objects for erase_if that the containers recognise and vectorise.
+ *
+ * They behave like the equivalent lambdas (`ts::pred::less{10}` is `[](auto x) { return x < 10; }`),
+ * but on vectors of 32/64-bit integers, float or double, erase_if evaluates them on whole
+ * SIMD registers (AVX2 or AVX-512, picked at runtime) and compacts the survivors without
+ * branches, so the lock is held for a fraction of the time. Any other element type, or
+ * an operand whose type would widen the comparison (e.g. a double bound on an int
+ * vector), silently uses the scalar path with the same result.
+ */
+namespace pred {
+
+template <class V>
+struct less {
+    using value_type = V;
+    static constexpr detail::filter_op op = detail::filter_op::less;
+
+    constexpr explicit less(V v) : value(v) {}
+
+    template <class U>
+    constexpr bool operator()(const U& x) const {
+        return detail::filter_apply<op>(x, value, value);
+    }
+
+    V value;
+};
+
+template <class V>
+struct less_equal {
+    using value_type = V;
+    static constexpr detail::filter_op op = detail::filter_op::less_equal;
+
+    constexpr explicit less_equal(V v) : value(v) {}
+
+    template <class U>
+    constexpr bool operator()(const U& x) const {
+        return detail::filter_apply<op>(x, value, value);
+    }
+
+    V value;
+};
+
+template <class V>
+struct greater {
+    using value_type = V;
+    static constexpr detail::filter_op op = detail::filter_op::greater;
+
+    constexpr explicit greater(V v) : value(v) {}
+
+    template <class U>
+    constexpr bool operator()(const U& x) const {
+        return detail::filter_apply<op>(x, value, value);
+    }
+
+    V value;
+};
+
+template <class V>
+struct greater_equal {
+    using value_type = V;
+    static constexpr detail::filter_op op = detail::filter_op::greater_equal;
+
+    constexpr explicit greater_equal(V v) : value(v) {}
+
+    template <class U>
+    constexpr bool operator()(const U& x) const {
+        return detail::filter_apply<op>(x, value, value);
+    }
+
+    V value;
+};
+
+template <class V>
+struct equal_to {
+    using value_type = V;
+    static constexpr detail::filter_op op = detail::filter_op::equal_to;
+
+    constexpr explicit equal_to(V v) : value(v) {}
+
+    template <class U>
+    constexpr bool operator()(const U& x) const {
+        return detail::filter_apply<op>(x, value, value);
+    }
+
+    V value;
+};
+
+template <class V>
+struct not_equal_to {
+    using value_type = V;
+    static constexpr detail::filter_op op = detail::filter_op::not_equal_to;
+
+    constexpr explicit not_equal_to(V v) : value(v) {}
+
+    template <class U>
+    constexpr bool operator()(const U& x) const {
+        return detail::filter_apply<op>(x, value, value);
+    }
+
+    V value;
+};
+
+// True for `lo <= x < hi`.
+template <class V>
+struct in_range {
+    using value_type = V;
+    static constexpr detail::filter_op op = detail::filter_op::in_range;
+
+    constexpr in_range(V lo, V hi) : lo(lo), hi(hi) {}
+
+    template <class U>
+    constexpr bool operator()(const U& x) const {
+        return detail::filter_apply<op>(x, lo, hi);
+    }
+
+    V lo;
+    V hi;
+};
+
+// True if `x & mask` is non-zero. Integral types only.
+template <class V>
+struct any_bits {
+    using value_type = V;
+    static constexpr detail::filter_op op = detail::filter_op::any_bits;
+
+    constexpr explicit any_bits(V mask) : mask(mask) {}
+
+    template <class U>
+    constexpr bool operator()(const U& x) const {
+        return detail::filter_apply<op>(x, mask, mask);
+    }
+
+    V mask;
+};
+
+} // namespace pred
+
+namespace detail {
+
+template <class T>
+inline constexpr bool simd_element_v =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8)) ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// A ts::pred object whose comparison, done in T, means exactly what it means in the scalar operator().
+template <class T, class Pred>
+concept simd_filter = requires {
+    typename Pred::value_type;
+    { Pred::op } -> std::convertible_to<filter_op>;
+} && simd_element_v<T> && std::is_arithmetic_v<typename Pred::value_type> &&
+    std::is_same_v<std::common_type_t<T, typename Pred::value_type>, T> &&
+    (Pred::op != filter_op::any_bits || std::is_integral_v<T>);
+
+// Both operands of a ts::pred object, converted to the element type.
+template <class T, class Pred>
+constexpr std::array<T, 2> filter_operands(const Pred& pred) {
+    if constexpr (Pred::op == filter_op::in_range) {
+        return {static_cast<T>(pred.lo), static_cast<T>(pred.hi)};
+    } else if constexpr (Pred::op == filter_op::any_bits) {
+        return {static_cast<T>(pred.mask), static_cast<T>(pred.mask)};
+    } else {
+        return {static_cast<T>(pred.value), static_cast<T>(pred.value)};
+    }
+}
+
+// Branchless compaction: every element is written, the output only advances past kept ones.
+template <filter_op Op, class T>
+T* remove_if_scalar(T* first, T* last, T* out, T a, T b) {
+    for (; first != last; ++first) {
+        T x = *first;
+        *out = x;
+        out += !filter_apply<Op>(x, a, b);
+    }
+    return out;
+}
+
+enum class simd_level { scalar, avx2, avx512 };
+
+#ifdef TS_FILTER_X86
+
+#define TS_FILTER_AVX2 __attribute__((target("avx2,popcnt"), always_inline)) inline
+#define TS_FILTER_AVX512 __attribute__((target("avx512f,popcnt"), always_inline)) inline
+
+// Row `mask` holds the 32-bit word indices that move the selected lanes to the front of a 256-bit register.
+template <size_t Lanes>
+constexpr auto make_compact_table() {
+    constexpr unsigned words = 8 / Lanes;
+    std::array<std::array<std::uint32_t, 8>, (size_t{1} << Lanes)> table{};
+    for (unsigned mask = 0; mask < table.size(); ++mask) {
+        unsigned out = 0;
+        for (unsigned lane = 0; lane < Lanes; ++lane) {
+            if ((mask & (1u << lane)) != 0) {
+                for (unsigned word = 0; word < words; ++word) {
+                    table[mask][out++] = lane * words + word;
+                }
+            }
+        }
+    }
+    return table;
+}
+
+template <size_t Lanes>
+alignas(32) inline constexpr auto compact_table = make_compact_table<Lanes>();
+
+template <class T>
+struct avx2_ops {
+    static constexpr unsigned lanes = 32 / sizeof(T);
+
+    TS_FILTER_AVX2 static __m256i set1(T v) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm256_castps_si256(_mm256_set1_ps(v));
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm256_castpd_si256(_mm256_set1_pd(v));
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_set1_epi32(static_cast<int>(v));
+        } else {
+            return _mm256_set1_epi64x(static_cast<long long>(v));
+        }
+    }
+
+    TS_FILTER_AVX2 static __m256i load(const T* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    TS_FILTER_AVX2 static __m256i gt(__m256i a, __m256i b) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_GT_OQ));
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_GT_OQ));
+        } else {
+            if constexpr (std::is_unsigned_v<T>) {
+                // AVX2 only compares signed integers; flipping the sign bit maps unsigned order onto signed order.
+                const __m256i bias = set1(T{1} << (sizeof(T) * 8 - 1));
+                a = _mm256_xor_si256(a, bias);
+                b = _mm256_xor_si256(b, bias);
+            }
+            if constexpr (sizeof(T) == 4) {
+                return _mm256_cmpgt_epi32(a, b);
+            } else {
+                return _mm256_cmpgt_epi64(a, b);
+            }
+        }
+    }
+
+    TS_FILTER_AVX2 static __m256i ge(__m256i a, __m256i b) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_GE_OQ));
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_GE_OQ));
+        } else {
+            return lnot(gt(b, a));
+        }
+    }
+
+    TS_FILTER_AVX2 static __m256i eq(__m256i a, __m256i b) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_cmpeq_epi32(a, b);
+        } else {
+            return _mm256_cmpeq_epi64(a, b);
+        }
+    }
+
+    TS_FILTER_AVX2 static __m256i lnot(__m256i m) {
+        return _mm256_xor_si256(m, _mm256_set1_epi32(-1));
+    }
+
+    template <filter_op Op>
+    TS_FILTER_AVX2 static __m256i matches(__m256i x, __m256i a, __m256i b) {
+        if constexpr (Op == filter_op::less) {
+            return gt(a, x);
+        } else if constexpr (Op == filter_op::less_equal) {
+            return ge(a, x);
+        } else if constexpr (Op == filter_op::greater) {
+            return gt(x, a);
+        } else if constexpr (Op == filter_op::greater_equal) {
+            return ge(x, a);
+        } else if constexpr (Op == filter_op::equal_to) {
+            return eq(x, a);
+        } else if constexpr (Op == filter_op::not_equal_to) {
+            return lnot(eq(x, a));
+        } else if constexpr (Op == filter_op::in_range) {
+            return _mm256_and_si256(ge(x, a), gt(b, x));
+        } else {
+            return lnot(eq(_mm256_and_si256(x, a), _mm256_setzero_si256()));
+        }
+    }
+
+    TS_FILTER_AVX2 static unsigned movemask(__m256i m) {
+        if constexpr (sizeof(T) == 4) {
+            return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+        } else {
+            return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+        }
+    }
+
+    // Moves the lanes selected by `keep` to the front of the register.
+    TS_FILTER_AVX2 static __m256i compact(__m256i x, unsigned keep) {
+        const auto* row = compact_table<lanes>[keep].data();
+        return _mm256_permutevar8x32_epi32(x, _mm256_load_si256(reinterpret_cast<const __m256i*>(row)));
+    }
+};
+
+template <class T>
+struct avx512_ops {
+    static constexpr unsigned lanes = 64 / sizeof(T);
+    using mask_type = std::conditional_t<sizeof(T) == 4, __mmask16, __mmask8>;
+
+    TS_FILTER_AVX512 static __m512i set1(T v) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm512_castps_si512(_mm512_set1_ps(v));
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm512_castpd_si512(_mm512_set1_pd(v));
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_set1_epi32(static_cast<int>(v));
+        } else {
+            return _mm512_set1_epi64(static_cast<long long>(v));
+        }
+    }
+
+    TS_FILTER_AVX512 static __m512i load(const T* p) {
+        return _mm512_loadu_si512(p);
+    }
+
+    // `IntPredicate` is an _MM_CMPINT_* constant, `FloatPredicate` the matching _CMP_* one.
+    template <int IntPredicate, int FloatPredicate>
+    TS_FILTER_AVX512 static mask_type cmp(__m512i a, __m512i b) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm512_cmp_ps_mask(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b), FloatPredicate);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm512_cmp_pd_mask(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b), FloatPredicate);
+        } else if constexpr (sizeof(T) == 4 && std::is_signed_v<T>) {
+            return _mm512_cmp_epi32_mask(a, b, IntPredicate);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_cmp_epu32_mask(a, b, IntPredicate);
+        } else if constexpr (std::is_signed_v<T>) {
+            return _mm512_cmp_epi64_mask(a, b, IntPredicate);
+        } else {
+            return _mm512_cmp_epu64_mask(a, b, IntPredicate);
+        }
+    }
+
+    template <filter_op Op>
+    TS_FILTER_AVX512 static mask_type matches(__m512i x, __m512i a, __m512i b) {
+        if constexpr (Op == filter_op::less) {
+            return cmp<_MM_CMPINT_LT, _CMP_LT_OQ>(x, a);
+        } else if constexpr (Op == filter_op::less_equal) {
+            return cmp<_MM_CMPINT_LE, _CMP_LE_OQ>(x, a);
+        } else if constexpr (Op == filter_op::greater) {
+            return cmp<_MM_CMPINT_NLE, _CMP_GT_OQ>(x, a);
+        } else if constexpr (Op == filter_op::greater_equal) {
+            return cmp<_MM_CMPINT_NLT, _CMP_GE_OQ>(x, a);
+        } else if constexpr (Op == filter_op::equal_to) {
+            return cmp<_MM_CMPINT_EQ, _CMP_EQ_OQ>(x, a);
+        } else if constexpr (Op == filter_op::not_equal_to) {
+            return cmp<_MM_CMPINT_NE, _CMP_NEQ_UQ>(x, a);
+        } else if constexpr (Op == filter_op::in_range) {
+            return cmp<_MM_CMPINT_NLT, _CMP_GE_OQ>(x, a) & cmp<_MM_CMPINT_LT, _CMP_LT_OQ>(x, b);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm512_test_epi32_mask(x, a);
+        } else {
+            return _mm512_test_epi64_mask(x, a);
+        }
+    }
+
+    // Register-to-register compress followed by a plain store; compressstoreu is microcoded on some cores.
+    TS_FILTER_AVX512 static __m512i compact(__m512i x, mask_type keep) {
+        if constexpr (sizeof(T) == 4) {
+            return _mm512_maskz_compress_epi32(keep, x);
+        } else {
+            return _mm512_maskz_compress_epi64(keep, x);
+        }
+    }
+};
+
+// The full-width store at `out` only touches elements that have already been loaded, because
+// `out` never passes `first`.
+template <filter_op Op, class T>
+__attribute__((target("avx2,popcnt"))) T* remove_if_avx2(T* first, T* last, T a, T b) {
+    using ops = avx2_ops<T>;
+    const __m256i va = ops::set1(a);
+    const __m256i vb = ops::set1(b);
+    T* out = first;
+    for (; last - first >= static_cast<std::ptrdiff_t>(ops::lanes); first += ops::lanes) {
+        __m256i x = ops::load(first);
+        unsigned keep = ~ops::movemask(ops::template matches<Op>(x, va, vb)) & ((1u << ops::lanes) - 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), ops::compact(x, keep));
+        out += std::popcount(keep);
+    }
+    return remove_if_scalar<Op>(first, last, out, a, b);
+}
+
+template <filter_op Op, class T>
+__attribute__((target("avx512f,popcnt"))) T* remove_if_avx512(T* first, T* last, T a, T b) {
+    using ops = avx512_ops<T>;
+    const __m512i va = ops::set1(a);
+    const __m512i vb = ops::set1(b);
+    T* out = first;
+    for (; last - first >= static_cast<std::ptrdiff_t>(ops::lanes); first += ops::lanes) {
+        __m512i x = ops::load(first);
+        auto keep = static_cast<typename ops::mask_type>(~ops::template matches<Op>(x, va, vb));
+        _mm512_storeu_si512(out, ops::compact(x, keep));
+        out += std::popcount(static_cast<unsigned>(keep));
+    }
+    return remove_if_scalar<Op>(first, last, out, a, b);
+}
+
+#undef TS_FILTER_AVX2
+#undef TS_FILTER_AVX512
+
+#endif // TS_FILTER_X86
+
+// Best kernel this CPU (and OS) supports, detected once.
+inline simd_level detected_simd_level() {
+    static const simd_level level = [] {
+#ifdef TS_FILTER_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return simd_level::avx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return simd_level::avx2;
+        }
+#endif
+        return simd_level::scalar;
+    }();
+    return level;
+}
+
+/**
+ * @brief remove_if over [first, last) for a ts::pred object, using the widest kernel up to `level`.
+ *
+ * Returns the new end. Kept elements stay in order; the ones past the new end are unspecified.
+ */
+template <class T, class Pred>
+    requires simd_filter<T, Pred>
+T* simd_remove_if(T* first, T* last, const Pred& pred, simd_level level = detected_simd_level()) {
+    auto [a, b] = filter_operands<T>(pred);
+#ifdef TS_FILTER_X86
+    if (level == simd_level::avx512) {
+        return remove_if_avx512<Pred::op>(first, last, a, b);
+    }
+    if (level == simd_level::avx2) {
+        return remove_if_avx2<Pred::op>(first, last, a, b);
+    }
+#else
+    (void)level;
+#endif
+    return remove_if_scalar<Pred::op>(first, last, first, a, b);
+}
+
+// std::remove_if that takes the vector kernels when the element type and predicate allow it.
+template <std::random_access_iterator It, class Pred>
+It filter_remove_if(It first, It last, Pred& pred) {
+    using T = std::iter_value_t<It>;
+    if constexpr (std::contiguous_iterator<It> && simd_filter<T, std::remove_const_t<Pred>>) {
+        T* begin = std::to_address(first);
+        return first + (simd_remove_if(begin, begin + (last - first), pred) - begin);
+    } else {
+        return std::remove_if(first, last, std::ref(pred));
+    }
+}
+
+} // namespace detail
+
+} // namespace ts
+
+#endif // TS_FILTER_H
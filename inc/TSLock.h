@@ -0,0 +1,389 @@
+#ifndef TS_LOCK_H
+#define TS_LOCK_H
+
+#include "TSCommon.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace ts {
+
+/*
+ * Lock policies for the LockPolicy parameter of ts::vector and ts::deque. Any type with
+ * lock / try_lock / unlock works; these cover the usual trade-offs:
+ *
+ *   std::mutex                 default; plain exclusive lock, sleeps in the kernel when contended
+ *   std::shared_mutex          const operations (size, read, snapshot, ...) share the lock
+ *   ts::spinlock               never sleeps; for very short critical sections with few threads
+ *   ts::adaptive_mutex         spins briefly, then sleeps on a futex
+ *   ts::flat_combining_mutex   lock holder runs the waiters' operations for them
+ *   ts::null_mutex             no locking at all, for single-threaded phases
+ */
+
+namespace detail {
+
+// Tells the core this is a spin-wait loop (cheaper for the sibling hyper-thread, less power).
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace detail
+
+/**
+ * @brief Test-and-test-and-set spinlock with exponential backoff.
+ *
+ * Waiters spin on a plain load, so the lock's cache line stays shared until it is released,
+ * and back off exponentially between attempts. After a bounded amount of spinning they
+ * yield the CPU, which keeps oversubscribed systems making progress.
+ */
+class spinlock {
+public:
+    spinlock() = default;
+
+    spinlock(const spinlock&) = delete;
+    spinlock& operator=(const spinlock&) = delete;
+
+    void lock() noexcept {
+        for (unsigned backoff = 1; !try_lock();) {
+            while (locked_.load(std::memory_order_relaxed)) {
+                if (backoff <= max_backoff) {
+                    for (unsigned i = 0; i < backoff; ++i) {
+                        detail::cpu_relax();
+                    }
+                    backoff <<= 1;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    NO_DISCARD bool try_lock() noexcept {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() noexcept {
+        locked_.store(false, std::memory_order_release);
+    }
+
+private:
+    static constexpr unsigned max_backoff = 1024;
+
+    std::atomic<bool> locked_{false};
+};
+
+/**
+ * @brief Spin-then-sleep mutex.
+ *
+ * Spins for a short while in the hope that the holder is about to release the lock, then
+ * sleeps on the lock word (std::atomic::wait, a futex on Linux). The lock word records
+ * whether anybody sleeps, so an uncontended unlock is a single atomic exchange.
+ */
+class adaptive_mutex {
+public:
+    adaptive_mutex() = default;
+
+    adaptive_mutex(const adaptive_mutex&) = delete;
+    adaptive_mutex& operator=(const adaptive_mutex&) = delete;
+
+    void lock() noexcept {
+        for (int spin = 0; spin < spin_limit; ++spin) {
+            if (try_lock()) {
+                return;
+            }
+            detail::cpu_relax();
+        }
+
+        // From here on announce a sleeper; whoever unlocks a contended lock wakes one up.
+        while (state_.exchange(locked_contended, std::memory_order_acquire) != unlocked) {
+            state_.wait(locked_contended, std::memory_order_relaxed);
+        }
+    }
+
+    NO_DISCARD bool try_lock() noexcept {
+        std::uint32_t expected = unlocked;
+        return state_.load(std::memory_order_relaxed) == unlocked &&
+               state_.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() noexcept {
+        if (state_.exchange(unlocked, std::memory_order_release) == locked_contended) {
+            state_.notify_one();
+        }
+    }
+
+private:
+    enum : std::uint32_t { unlocked, locked, locked_contended };
+
+    static constexpr int spin_limit = 100;
+
+    std::atomic<std::uint32_t> state_{unlocked};
+};
+
+/**
+ * @brief Lock that does nothing, for containers that are only used by one thread at a time.
+ *
+ * Lets the same container type be filled single-threaded without paying for atomics.
+ * Never use the blocking operations of ts::deque with it: there is nobody to wake them.
+ */
+class null_mutex {
+public:
+    void lock() noexcept {}
+
+    NO_DISCARD bool try_lock() noexcept {
+        return true;
+    }
+
+    void unlock() noexcept {}
+};
+
+/**
+ * @brief Mutex that can execute other threads' critical sections on their behalf (flat combining).
+ *
+ * It is a regular Lockable (lock / try_lock / unlock), so it works with std::lock_guard,
+ * std::unique_lock, std::lock and std::condition_variable_any. On top of that, combine(op)
+ * runs `op` under the lock without necessarily taking it: a thread that finds the lock busy
+ * publishes `op` in its slot and spins on that slot. Whoever holds the lock runs every
+ * published operation before releasing it, so a burst of short critical sections executes
+ * back to back on one core, with the protected data hot in its cache, instead of the lock's
+ * cache line bouncing between all of them.
+ *
+ * Pass it as the Lock parameter of ts::vector or ts::deque to opt in:
+ *
+ *     ts::deque<int, std::allocator<int>, ts::flat_combining_mutex> dq;
+ *
+ * Operations passed to combine() may therefore run on another thread. Exceptions are
+ * captured and rethrown in the publishing thread. Threads beyond the slot count (or
+ * sharing a slot with a thread that is mid-operation) fall back to lock() / unlock().
+ */
+class flat_combining_mutex {
+public:
+    static constexpr size_t slot_count = 64;
+
+    flat_combining_mutex() = default;
+
+    flat_combining_mutex(const flat_combining_mutex&) = delete;
+    flat_combining_mutex& operator=(const flat_combining_mutex&) = delete;
+
+    void lock() noexcept {
+        for (int spin = 0; !try_lock(); ++spin) {
+            if (spin < 64) {
+                std::this_thread::yield();
+            } else {
+                locked_.wait(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    NO_DISCARD bool try_lock() noexcept {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() noexcept {
+        locked_.store(false, std::memory_order_release);
+        locked_.notify_one();
+    }
+
+    /**
+     * @brief Runs `op` with the lock held, possibly on the thread that currently holds it.
+     *
+     * Returns whatever `op` returns (references included) and rethrows what it throws.
+     */
+    template <class F>
+    decltype(auto) combine(F&& op) {
+        using result_type = std::invoke_result_t<F&>;
+
+        if (try_lock()) {
+            combining_guard guard(*this);
+            return std::invoke(op);
+        }
+
+        slot* own = claim_slot();
+        if (own == nullptr) {
+            lock();
+            combining_guard guard(*this);
+            return std::invoke(op);
+        }
+
+        published_op<F, result_type> published(op);
+        own->context = &published;
+        own->run = &published_op<F, result_type>::run;
+        // Counted before it becomes visible, so a combiner can never decrement past zero.
+        published_count_.fetch_add(1, std::memory_order_relaxed);
+        own->state.store(slot_pending, std::memory_order_release);
+
+        for (int spin = 0; own->state.load(std::memory_order_acquire) != slot_done; ++spin) {
+            if (try_lock()) {
+                run_published();
+                unlock();
+            } else if (spin > 16) {
+                std::this_thread::yield();
+            }
+        }
+        own->state.store(slot_free, std::memory_order_release);
+        return published.take();
+    }
+
+private:
+    enum : std::uint32_t { slot_free, slot_claimed, slot_pending, slot_done };
+
+    struct alignas(detail::cache_line_size) slot {
+        std::atomic<std::uint32_t> state{slot_free};
+        void (*run)(void*) noexcept = nullptr;
+        void* context = nullptr;
+    };
+
+    // Lives on the publishing thread's stack until that thread sees slot_done.
+    template <class F, class R>
+    struct published_op {
+        using stored_type = std::conditional_t<std::is_reference_v<R>, std::remove_reference_t<R>*, R>;
+
+        explicit published_op(F& op) : op(op) {}
+
+        static void run(void* context) noexcept {
+            auto* self = static_cast<published_op*>(context);
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    std::invoke(self->op);
+                } else if constexpr (std::is_reference_v<R>) {
+                    self->result.emplace(&std::invoke(self->op));
+                } else {
+                    self->result.emplace(std::invoke(self->op));
+                }
+            } catch (...) {
+                self->error = std::current_exception();
+            }
+        }
+
+        R take() {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            if constexpr (std::is_reference_v<R>) {
+                return static_cast<R>(**result);
+            } else if constexpr (!std::is_void_v<R>) {
+                return std::move(*result);
+            }
+        }
+
+        F& op;
+        std::exception_ptr error;
+        std::conditional_t<std::is_void_v<R>, std::nullopt_t, std::optional<stored_type>> result{std::nullopt};
+    };
+
+    // Serves everyone who published while this thread held the lock, then releases it.
+    struct combining_guard {
+        explicit combining_guard(flat_combining_mutex& owner) : owner(owner) {}
+
+        ~combining_guard() {
+            owner.run_published();
+            owner.unlock();
+        }
+
+        flat_combining_mutex& owner;
+    };
+
+    slot* claim_slot() noexcept {
+        size_t index = detail::thread_slot() % slot_count;
+        std::uint32_t expected = slot_free;
+        if (!slots_[index].state.compare_exchange_strong(expected, slot_claimed, std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        size_t used = slots_in_use_.load(std::memory_order_relaxed);
+        while (used <= index && !slots_in_use_.compare_exchange_weak(used, index + 1, std::memory_order_relaxed)) {
+        }
+        return &slots_[index];
+    }
+
+    // Caller holds the lock. Repeats while passes keep finding work, up to a small bound.
+    // The counter keeps the uncontended path from scanning the slots at all; an operation
+    // missed because the count was not visible yet is picked up by its own thread.
+    void run_published() noexcept {
+        for (int pass = 0; pass < 4 && published_count_.load(std::memory_order_acquire) != 0; ++pass) {
+            size_t ran = 0;
+            size_t used = slots_in_use_.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < used; ++i) {
+                slot& candidate = slots_[i];
+                if (candidate.state.load(std::memory_order_acquire) == slot_pending) {
+                    candidate.run(candidate.context);
+                    candidate.state.store(slot_done, std::memory_order_release);
+                    ++ran;
+                }
+            }
+            if (ran == 0) {
+                return;
+            }
+            published_count_.fetch_sub(ran, std::memory_order_relaxed);
+        }
+    }
+
+    alignas(detail::cache_line_size) std::atomic<bool> locked_{false};
+    std::atomic<size_t> slots_in_use_{0};
+    std::atomic<size_t> published_count_{0};
+    std::array<slot, slot_count> slots_;
+};
+
+namespace detail {
+
+template <class Lock>
+concept combining_lock = requires(Lock& lock) {
+    lock.combine([] {});
+};
+
+// Runs `op` under `lock`, handing it to the current holder when the lock supports combining.
+template <class Lock, class F>
+decltype(auto) with_lock(Lock& lock, F&& op) {
+    if constexpr (combining_lock<Lock>) {
+        return lock.combine(std::forward<F>(op));
+    } else {
+        std::lock_guard guard(lock);
+        return std::invoke(std::forward<F>(op));
+    }
+}
+
+template <class Lock>
+concept shared_lockable = requires(Lock& lock) {
+    lock.lock_shared();
+    lock.unlock_shared();
+};
+
+// Holds `Lock` shared if it supports that, exclusively otherwise.
+template <class Lock>
+using shared_guard = std::conditional_t<shared_lockable<Lock>, std::shared_lock<Lock>, std::unique_lock<Lock>>;
+
+// Runs a read-only `op` under a shared lock when Lock has one, otherwise exactly like with_lock().
+template <class Lock, class F>
+decltype(auto) with_shared_lock(Lock& lock, F&& op) {
+    if constexpr (shared_lockable<Lock>) {
+        std::shared_lock guard(lock);
+        return std::invoke(std::forward<F>(op));
+    } else {
+        return with_lock(lock, std::forward<F>(op));
+    }
+}
+
+// std::condition_variable only accepts std::unique_lock<std::mutex>; any other lock needs the generic one.
+template <class Lock>
+using condition_variable_for =
+    std::conditional_t<std::is_same_v<Lock, std::mutex>, std::condition_variable, std::condition_variable_any>;
+
+} // namespace detail
+
+} // namespace ts
+
+#endif // TS_LOCK_H
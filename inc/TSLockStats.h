@@ -0,0 +1,504 @@
+#ifndef TS_LOCK_STATS_H
+#define TS_LOCK_STATS_H
+
+#include "TSCommon.h"
+#include "TSLock.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ * Opt-in lock instrumentation.
+ *
+ * Define TS_ENABLE_LOCK_STATS (for the whole program, e.g. with the CMake option of the same
+ * name) and the lock of every ts::vector and ts::deque is wrapped in detail::stats_lock, which
+ * counts acquisitions and contended acquisitions, measures wait and hold times and remembers
+ * which operation held the lock longest. The numbers are available per container through
+ * stats() and for every live container through ts::lock_registry::instance().dump().
+ *
+ * Without the macro the containers use LockPolicy directly, TS_LOCK_SITE() expands to nothing
+ * and stats() returns zeros: no code, no data, no registration.
+ *
+ * Mixing translation units with and without the macro breaks the one-definition rule.
+ */
+
+#ifdef TS_ENABLE_LOCK_STATS
+// Names the calling member function as the operation holding the container's lock.
+#define TS_LOCK_SITE() ::ts::detail::lock_site ts_lock_site_(__func__)
+#else
+#define TS_LOCK_SITE() static_cast<void>(0)
+#endif
+
+namespace ts {
+
+/**
+ * @brief Counters of one instrumented lock, as returned by stats().
+ *
+ * Wait is the time between asking for the lock and getting it; hold is the time from getting
+ * it to releasing it. Hold times are measured for exclusive ownership only: shared holders
+ * overlap, so their acquisitions and waits are counted but their holds are not.
+ */
+struct lock_stats {
+    static constexpr size_t hold_buckets = 20;
+
+    std::uint64_t acquisitions = 0;
+    // Acquisitions that could not take the lock immediately.
+    std::uint64_t contended = 0;
+    std::chrono::nanoseconds total_wait{0};
+    std::chrono::nanoseconds max_wait{0};
+    std::chrono::nanoseconds total_hold{0};
+    std::chrono::nanoseconds max_hold{0};
+    // The operation (container member function) behind max_hold, or nullptr.
+    const char* max_hold_site = nullptr;
+    // Bucket 0 counts holds under 64 ns, bucket k holds in [2^(k+5), 2^(k+6)) ns; the last is open-ended.
+    std::array<std::uint64_t, hold_buckets> hold_histogram{};
+
+    static size_t hold_bucket(std::chrono::nanoseconds hold) noexcept {
+        auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(hold.count(), 0));
+        return std::min(static_cast<size_t>(std::bit_width(ns >> 6)), hold_buckets - 1);
+    }
+
+    static std::chrono::nanoseconds bucket_floor(size_t bucket) noexcept {
+        return std::chrono::nanoseconds(bucket == 0 ? 0 : std::int64_t{1} << (bucket + 5));
+    }
+};
+
+namespace detail {
+class lock_stats_recorder;
+} // namespace detail
+
+/**
+ * @brief Every live instrumented lock, for finding the hot ones.
+ *
+ * Empty unless TS_ENABLE_LOCK_STATS is defined.
+ */
+class lock_registry {
+public:
+    struct entry {
+        // Set with the container's set_stats_label(); empty otherwise.
+        std::string label;
+        const void* lock;
+        lock_stats stats;
+    };
+
+    static lock_registry& instance() {
+        // Intentionally leaked: containers with static storage deregister during shutdown.
+        static lock_registry* registry = new lock_registry;
+        return *registry;
+    }
+
+    /**
+     * @brief Counters of every registered lock, most total wait first.
+     */
+    NO_DISCARD std::vector<entry> snapshot() const;
+
+    /**
+     * @brief Writes snapshot() in human-readable form, one lock per paragraph.
+     */
+    void dump(std::ostream& out) const;
+
+    /**
+     * @brief Zeroes the counters of every registered lock.
+     */
+    void reset();
+
+private:
+    friend class detail::lock_stats_recorder;
+
+    lock_registry() = default;
+
+    void add(detail::lock_stats_recorder* recorder);
+    void remove(detail::lock_stats_recorder* recorder);
+
+    mutable std::mutex mutex_;
+    detail::lock_stats_recorder* head_ = nullptr;
+};
+
+namespace detail {
+
+// The operation on whose behalf this thread currently takes locks; see TS_LOCK_SITE().
+inline thread_local const char* current_lock_site = nullptr;
+
+class lock_site {
+public:
+    explicit lock_site(const char* name) noexcept : previous_(std::exchange(current_lock_site, name)) {}
+
+    lock_site(const lock_site&) = delete;
+    lock_site& operator=(const lock_site&) = delete;
+
+    ~lock_site() {
+        current_lock_site = previous_;
+    }
+
+private:
+    const char* previous_;
+};
+
+/**
+ * @brief The counters behind one stats_lock, linked into the lock_registry while alive.
+ */
+class lock_stats_recorder {
+public:
+    lock_stats_recorder() {
+        lock_registry::instance().add(this);
+    }
+
+    lock_stats_recorder(const lock_stats_recorder&) = delete;
+    lock_stats_recorder& operator=(const lock_stats_recorder&) = delete;
+
+    ~lock_stats_recorder() {
+        lock_registry::instance().remove(this);
+    }
+
+    void record_acquire(bool contended, std::chrono::nanoseconds wait) noexcept {
+        acquisitions_.fetch_add(1, std::memory_order_relaxed);
+        if (contended) {
+            contended_.fetch_add(1, std::memory_order_relaxed);
+            total_wait_.fetch_add(wait.count(), std::memory_order_relaxed);
+            raise(max_wait_, wait.count());
+        }
+    }
+
+    void record_hold(std::chrono::nanoseconds hold, const char* site) noexcept {
+        total_hold_.fetch_add(hold.count(), std::memory_order_relaxed);
+        hold_histogram_[lock_stats::hold_bucket(hold)].fetch_add(1, std::memory_order_relaxed);
+        if (raise(max_hold_, hold.count())) {
+            // Not atomic with max_hold_: two racing records may pair one's time with the other's site.
+            max_hold_site_.store(site, std::memory_order_relaxed);
+        }
+    }
+
+    NO_DISCARD lock_stats read() const noexcept {
+        lock_stats result;
+        result.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+        result.contended = contended_.load(std::memory_order_relaxed);
+        result.total_wait = std::chrono::nanoseconds(total_wait_.load(std::memory_order_relaxed));
+        result.max_wait = std::chrono::nanoseconds(max_wait_.load(std::memory_order_relaxed));
+        result.total_hold = std::chrono::nanoseconds(total_hold_.load(std::memory_order_relaxed));
+        result.max_hold = std::chrono::nanoseconds(max_hold_.load(std::memory_order_relaxed));
+        result.max_hold_site = max_hold_site_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < lock_stats::hold_buckets; ++i) {
+            result.hold_histogram[i] = hold_histogram_[i].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    void reset() noexcept {
+        acquisitions_.store(0, std::memory_order_relaxed);
+        contended_.store(0, std::memory_order_relaxed);
+        total_wait_.store(0, std::memory_order_relaxed);
+        max_wait_.store(0, std::memory_order_relaxed);
+        total_hold_.store(0, std::memory_order_relaxed);
+        max_hold_.store(0, std::memory_order_relaxed);
+        max_hold_site_.store(nullptr, std::memory_order_relaxed);
+        for (auto& bucket : hold_histogram_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void set_label(std::string label) {
+        std::lock_guard lock(lock_registry::instance().mutex_);
+        label_ = std::move(label);
+    }
+
+private:
+    friend class ts::lock_registry;
+
+    // Returns true if `value` became the new maximum.
+    static bool raise(std::atomic<std::int64_t>& maximum, std::int64_t value) noexcept {
+        std::int64_t current = maximum.load(std::memory_order_relaxed);
+        while (value > current) {
+            if (maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::atomic<std::uint64_t> acquisitions_{0};
+    std::atomic<std::uint64_t> contended_{0};
+    std::atomic<std::int64_t> total_wait_{0};
+    std::atomic<std::int64_t> max_wait_{0};
+    std::atomic<std::int64_t> total_hold_{0};
+    std::atomic<std::int64_t> max_hold_{0};
+    std::atomic<const char*> max_hold_site_{nullptr};
+    std::array<std::atomic<std::uint64_t>, lock_stats::hold_buckets> hold_histogram_{};
+
+    // Guarded by the registry's mutex.
+    std::string label_;
+    lock_stats_recorder* prev_ = nullptr;
+    lock_stats_recorder* next_ = nullptr;
+};
+
+/**
+ * @brief `Lock` with a lock_stats_recorder attached; a drop-in replacement for it.
+ *
+ * Provides lock_shared() and friends only if `Lock` does, and combine() only if `Lock` is a
+ * combining lock, so detail::with_lock(), shared_guard and condition_variable_for pick the
+ * same strategy as for the bare lock. An uncontended acquisition costs one extra try_lock()
+ * check and two clock reads.
+ */
+template <class Lock>
+class stats_lock {
+public:
+    using clock = std::chrono::steady_clock;
+
+    stats_lock() = default;
+
+    stats_lock(const stats_lock&) = delete;
+    stats_lock& operator=(const stats_lock&) = delete;
+
+    void lock() {
+        if (lock_.try_lock()) {
+            recorder_.record_acquire(false, {});
+        } else {
+            auto start = clock::now();
+            lock_.lock();
+            recorder_.record_acquire(true, clock::now() - start);
+        }
+        held_since_ = clock::now();
+    }
+
+    NO_DISCARD bool try_lock() {
+        if (!lock_.try_lock()) {
+            return false;
+        }
+        recorder_.record_acquire(false, {});
+        held_since_ = clock::now();
+        return true;
+    }
+
+    void unlock() {
+        recorder_.record_hold(clock::now() - held_since_, current_lock_site);
+        lock_.unlock();
+    }
+
+    void lock_shared()
+        requires shared_lockable<Lock>
+    {
+        if (lock_.try_lock_shared()) {
+            recorder_.record_acquire(false, {});
+            return;
+        }
+        auto start = clock::now();
+        lock_.lock_shared();
+        recorder_.record_acquire(true, clock::now() - start);
+    }
+
+    NO_DISCARD bool try_lock_shared()
+        requires shared_lockable<Lock>
+    {
+        if (!lock_.try_lock_shared()) {
+            return false;
+        }
+        recorder_.record_acquire(false, {});
+        return true;
+    }
+
+    void unlock_shared()
+        requires shared_lockable<Lock>
+    {
+        lock_.unlock_shared();
+    }
+
+    /**
+     * @brief Forwards to Lock::combine(). The hold is the time `op` ran, wherever it ran; the
+     * wait is the rest of the call. The acquisition counts as contended if another thread ran `op`.
+     */
+    template <class F>
+        requires combining_lock<Lock>
+    decltype(auto) combine(F&& op) {
+        const char* site = current_lock_site;
+        auto caller = std::this_thread::get_id();
+        auto start = clock::now();
+        std::chrono::nanoseconds held{0};
+        bool handed_off = false;
+
+        struct hold_timer {
+            std::chrono::nanoseconds& held;
+            clock::time_point since = clock::now();
+            ~hold_timer() {
+                held = clock::now() - since;
+            }
+        };
+
+        struct wait_recorder {
+            stats_lock& owner;
+            const char* site;
+            clock::time_point start;
+            std::chrono::nanoseconds& held;
+            bool& handed_off;
+            ~wait_recorder() {
+                owner.recorder_.record_hold(held, site);
+                owner.recorder_.record_acquire(handed_off, clock::now() - start - held);
+            }
+        } recorder{*this, site, start, held, handed_off};
+
+        return lock_.combine([&]() -> decltype(auto) {
+            handed_off = std::this_thread::get_id() != caller;
+            hold_timer timer{held};
+            return std::invoke(std::forward<F>(op));
+        });
+    }
+
+    NO_DISCARD lock_stats stats() const noexcept {
+        return recorder_.read();
+    }
+
+    void reset_stats() noexcept {
+        recorder_.reset();
+    }
+
+    void set_label(std::string label) {
+        recorder_.set_label(std::move(label));
+    }
+
+private:
+    Lock lock_;
+    lock_stats_recorder recorder_;
+    // Written only by the exclusive owner.
+    clock::time_point held_since_;
+};
+
+#ifdef TS_ENABLE_LOCK_STATS
+template <class Lock>
+using instrumented_lock_t = stats_lock<Lock>;
+#else
+template <class Lock>
+using instrumented_lock_t = Lock;
+#endif
+
+template <class Lock>
+lock_stats lock_stats_of(const Lock& lock) {
+    if constexpr (requires { lock.stats(); }) {
+        return lock.stats();
+    } else {
+        return {};
+    }
+}
+
+template <class Lock>
+void set_lock_stats_label(Lock& lock, std::string label) {
+    if constexpr (requires { lock.set_label(std::move(label)); }) {
+        lock.set_label(std::move(label));
+    }
+}
+
+template <class Lock>
+void reset_lock_stats(Lock& lock) {
+    if constexpr (requires { lock.reset_stats(); }) {
+        lock.reset_stats();
+    }
+}
+
+inline void write_duration(std::ostream& out, std::chrono::nanoseconds duration) {
+    auto ns = static_cast<double>(duration.count());
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    if (ns < 1e3) {
+        out << ns << " ns";
+    } else if (ns < 1e6) {
+        out << ns / 1e3 << " us";
+    } else if (ns < 1e9) {
+        out << ns / 1e6 << " ms";
+    } else {
+        out << ns / 1e9 << " s";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace detail
+
+inline std::vector<lock_registry::entry> lock_registry::snapshot() const {
+    std::vector<entry> entries;
+    {
+        std::lock_guard lock(mutex_);
+        for (const detail::lock_stats_recorder* r = head_; r != nullptr; r = r->next_) {
+            entries.push_back({r->label_, r, r->read()});
+        }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const entry& a, const entry& b) { return a.stats.total_wait > b.stats.total_wait; });
+    return entries;
+}
+
+inline void lock_registry::dump(std::ostream& out) const {
+#ifndef TS_ENABLE_LOCK_STATS
+    out << "lock statistics are disabled (define TS_ENABLE_LOCK_STATS)\n";
+#endif
+    for (const entry& e : snapshot()) {
+        const lock_stats& s = e.stats;
+        if (e.label.empty()) {
+            out << "lock " << e.lock;
+        } else {
+            out << e.label << " (" << e.lock << ')';
+        }
+        out << ": " << s.acquisitions << " acquisitions, " << s.contended << " contended";
+        out << ", wait total ";
+        detail::write_duration(out, s.total_wait);
+        out << " max ";
+        detail::write_duration(out, s.max_wait);
+        out << ", hold total ";
+        detail::write_duration(out, s.total_hold);
+        out << " max ";
+        detail::write_duration(out, s.max_hold);
+        if (s.max_hold_site != nullptr) {
+            out << " in " << s.max_hold_site << "()";
+        }
+        out << "\n  hold histogram:";
+        for (size_t i = 0; i < lock_stats::hold_buckets; ++i) {
+            if (s.hold_histogram[i] != 0) {
+                out << " >=";
+                detail::write_duration(out, lock_stats::bucket_floor(i));
+                out << ':' << s.hold_histogram[i];
+            }
+        }
+        out << '\n';
+    }
+}
+
+inline void lock_registry::reset() {
+    std::lock_guard lock(mutex_);
+    for (detail::lock_stats_recorder* r = head_; r != nullptr; r = r->next_) {
+        r->reset();
+    }
+}
+
+inline void lock_registry::add(detail::lock_stats_recorder* recorder) {
+    std::lock_guard lock(mutex_);
+    recorder->next_ = head_;
+    if (head_ != nullptr) {
+        head_->prev_ = recorder;
+    }
+    head_ = recorder;
+}
+
+inline void lock_registry::remove(detail::lock_stats_recorder* recorder) {
+    std::lock_guard lock(mutex_);
+    if (recorder->prev_ != nullptr) {
+        recorder->prev_->next_ = recorder->next_;
+    } else {
+        head_ = recorder->next_;
+    }
+    if (recorder->next_ != nullptr) {
+        recorder->next_->prev_ = recorder->prev_;
+    }
+}
+
+} // namespace ts
+
+#endif // TS_LOCK_STATS_H
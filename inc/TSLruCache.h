@@ -0,0 +1,457 @@
+#ifndef TS_LRU_CACHE_H
+#define TS_LRU_CACHE_H
+
+#include <unordered_map>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <optional>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <thread>
+#include <utility>
+#include <cstdint>
+
+#include "TSCommon.h"
+
+namespace ts {
+
+/**
+ * @brief Every entry weighs 1, so the cache capacity counts entries.
+ */
+struct unit_weigher {
+    template <typename K, typename V>
+    size_t operator()(const K&, const V&) const noexcept {
+        return 1;
+    }
+};
+
+/**
+ * @brief Counters reported by lru_cache::stats().
+ */
+struct cache_stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+};
+
+/**
+ * @brief Bounded, sharded cache with CLOCK (second-chance) eviction.
+ *
+ * Keys are spread over shards by hash; every shard owns an equal part of the capacity (the
+ * first `capacity % shard_count` shards one unit more, so the parts sum to `capacity`), its
+ * own shared_mutex, index and clock ring. A hit takes the shard lock shared and only sets
+ * the entry's reference bit, so concurrent hits never serialise on a recency list the way
+ * a linked-list LRU does. Inserts take the shard lock exclusively; when the shard is over
+ * capacity its clock hand sweeps the ring, clearing reference bits and evicting the first
+ * entry that has not been used since the previous sweep. That approximates LRU closely for
+ * typical skewed workloads.
+ *
+ * `Weigher` returns the weight of an entry (default: 1 per entry). Pass e.g.
+ * `[](const K&, const std::string& v) { return v.size(); }` and a byte capacity to bound
+ * the cache by size instead of count. An entry heavier than its shard's capacity is not cached.
+ *
+ * get_or_load() deduplicates concurrent misses: only one caller runs the loader for a key,
+ * the others wait for its result.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename Weigher = unit_weigher>
+class lru_cache {
+public:
+    using key_type = K;
+    using mapped_type = V;
+
+    /**
+     * @brief A cache holding up to `capacity` weight units, split over `shard_count` shards.
+     *
+     * `shard_count` is rounded up to a power of two. By default there are up to four shards per
+     * hardware thread, rounded down to a power of two so that no shard holds fewer than 8 units.
+     */
+    explicit lru_cache(size_t capacity, size_t shard_count = 0, const Weigher& weigher = Weigher(),
+                       const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+        : shard_count_(detail::round_up_pow2(shard_count != 0 ? shard_count : default_shard_count(capacity))),
+          capacity_(capacity), hash_(hash), weigher_(weigher), shards_(std::make_unique<shard[]>(shard_count_)) {
+        size_t per_shard = capacity / shard_count_;
+        size_t remainder = capacity % shard_count_;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            shards_[i].capacity = per_shard + (i < remainder ? 1 : 0);
+            shards_[i].index = index_type(0, hash, equal);
+            shards_[i].loading = loading_type(0, hash, equal);
+        }
+    }
+
+    lru_cache(const lru_cache&) = delete;
+    lru_cache& operator=(const lru_cache&) = delete;
+
+    ~lru_cache() = default;
+
+    /**
+     * @brief Returns a copy of the cached value and marks it as recently used, or std::nullopt.
+     */
+    NO_DISCARD std::optional<V> get(const K& key) {
+        shard& s = shard_for(key);
+        {
+            std::shared_lock lock(s.mutex);
+            auto it = s.index.find(key);
+            if (it != s.index.end()) {
+                slot& entry = s.slots[it->second];
+                touch(entry);
+                s.stats.hits.fetch_add(1, std::memory_order_relaxed);
+                return *entry.value;
+            }
+        }
+        s.stats.misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    NO_DISCARD bool contains(const K& key) const {
+        const shard& s = shard_for(key);
+        std::shared_lock lock(s.mutex);
+        return s.index.find(key) != s.index.end();
+    }
+
+    /**
+     * @brief Inserts or replaces the value under `key`, evicting as needed.
+     */
+    void put(const K& key, V value) {
+        shard& s = shard_for(key);
+        std::lock_guard lock(s.mutex);
+        store(s, key, std::move(value));
+    }
+
+    /**
+     * @brief Returns the cached value, or calls `loader()` once to produce and cache it.
+     *
+     * Concurrent callers missing on the same key wait for the single loader call and share its
+     * result (or its exception, which is rethrown to each of them and not cached). The loader
+     * runs without any lock held. A value put() for the key while it was loading is kept.
+     */
+    template <typename Loader>
+    V get_or_load(const K& key, Loader&& loader) {
+        if (std::optional<V> cached = get(key)) {
+            return std::move(*cached);
+        }
+
+        shard& s = shard_for(key);
+        std::shared_ptr<pending_load> load;
+        bool owner = false;
+        {
+            std::lock_guard lock(s.mutex);
+            // Loaded by someone else between the miss above and this lock.
+            auto cached = s.index.find(key);
+            if (cached != s.index.end()) {
+                return *s.slots[cached->second].value;
+            }
+            auto [it, inserted] = s.loading.try_emplace(key);
+            if (inserted) {
+                it->second = std::make_shared<pending_load>();
+            }
+            load = it->second;
+            owner = inserted;
+        }
+
+        if (!owner) {
+            return load->wait();
+        }
+
+        try {
+            V value = std::forward<Loader>(loader)();
+            {
+                std::lock_guard lock(s.mutex);
+                if (s.index.find(key) == s.index.end()) {
+                    store(s, key, value);
+                }
+                s.loading.erase(key);
+            }
+            load->finish(value);
+            return value;
+        } catch (...) {
+            {
+                std::lock_guard lock(s.mutex);
+                s.loading.erase(key);
+            }
+            load->fail(std::current_exception());
+            throw;
+        }
+    }
+
+    /**
+     * @brief Removes `key`. Returns true if it was cached.
+     */
+    bool erase(const K& key) {
+        shard& s = shard_for(key);
+        std::lock_guard lock(s.mutex);
+        auto it = s.index.find(key);
+        if (it == s.index.end()) {
+            return false;
+        }
+        release(s, it);
+        return true;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < shard_count_; ++i) {
+            shard& s = shards_[i];
+            std::lock_guard lock(s.mutex);
+            s.index.clear();
+            s.slots.clear();
+            s.free_slots.clear();
+            s.weight = 0;
+            s.hand = 0;
+        }
+    }
+
+    /**
+     * @brief Number of cached entries, summed shard by shard.
+     */
+    NO_DISCARD size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            std::shared_lock lock(shards_[i].mutex);
+            total += shards_[i].index.size();
+        }
+        return total;
+    }
+
+    /**
+     * @brief Total weight of the cached entries (their count with the default weigher).
+     */
+    NO_DISCARD size_t weight() const {
+        size_t total = 0;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            std::shared_lock lock(shards_[i].mutex);
+            total += shards_[i].weight;
+        }
+        return total;
+    }
+
+    NO_DISCARD size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    NO_DISCARD size_t shard_count() const noexcept {
+        return shard_count_;
+    }
+
+    /**
+     * @brief Hit, miss and eviction counts since construction (or the last reset_stats()).
+     *
+     * get_or_load() counts one hit or one miss per call; a caller that waited for another
+     * caller's load counts as a miss.
+     */
+    NO_DISCARD cache_stats stats() const {
+        cache_stats total;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            const counters& c = shards_[i].stats;
+            total.hits += c.hits.load(std::memory_order_relaxed);
+            total.misses += c.misses.load(std::memory_order_relaxed);
+            total.evictions += c.evictions.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void reset_stats() {
+        for (size_t i = 0; i < shard_count_; ++i) {
+            counters& c = shards_[i].stats;
+            c.hits.store(0, std::memory_order_relaxed);
+            c.misses.store(0, std::memory_order_relaxed);
+            c.evictions.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    using index_type = std::unordered_map<K, size_t, Hash, KeyEqual>;
+
+    // One clock ring position. `key` points at the key stored in the index node, which never moves.
+    struct slot {
+        const K* key = nullptr;
+        std::optional<V> value;
+        size_t weight = 0;
+        std::atomic<bool> referenced{false};
+    };
+
+    // Shared by every caller waiting on one get_or_load() miss.
+    class pending_load {
+    public:
+        V wait() {
+            std::unique_lock lock(mutex_);
+            done_.wait(lock, [&] { return value_.has_value() || error_ != nullptr; });
+            if (error_ != nullptr) {
+                std::rethrow_exception(error_);
+            }
+            return *value_;
+        }
+
+        void finish(const V& value) {
+            {
+                std::lock_guard lock(mutex_);
+                value_.emplace(value);
+            }
+            done_.notify_all();
+        }
+
+        void fail(std::exception_ptr error) {
+            {
+                std::lock_guard lock(mutex_);
+                error_ = std::move(error);
+            }
+            done_.notify_all();
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable done_;
+        std::optional<V> value_;
+        std::exception_ptr error_;
+    };
+
+    using loading_type = std::unordered_map<K, std::shared_ptr<pending_load>, Hash, KeyEqual>;
+
+    struct counters {
+        std::atomic<size_t> hits{0};
+        std::atomic<size_t> misses{0};
+        std::atomic<size_t> evictions{0};
+    };
+
+    struct alignas(detail::cache_line_size) shard {
+        mutable std::shared_mutex mutex;
+        index_type index;
+        // std::deque because slots hold atomics and must not move when the ring grows.
+        std::deque<slot> slots;
+        std::vector<size_t> free_slots;
+        loading_type loading;
+        size_t capacity = 0;
+        size_t weight = 0;
+        size_t hand = 0;
+        alignas(detail::cache_line_size) counters stats;
+    };
+
+    static size_t default_shard_count(size_t capacity) {
+        size_t wanted = size_t{4} * std::max(1u, std::thread::hardware_concurrency());
+        return std::bit_floor(std::max<size_t>(1, std::min(wanted, capacity / 8)));
+    }
+
+    // Skips the store when the bit is already set, so hot entries do not bounce their cache line.
+    static void touch(slot& entry) {
+        if (!entry.referenced.load(std::memory_order_relaxed)) {
+            entry.referenced.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    shard& shard_for(const K& key) {
+        return shards_[shard_index(key)];
+    }
+
+    const shard& shard_for(const K& key) const {
+        return shards_[shard_index(key)];
+    }
+
+    size_t shard_index(const K& key) const {
+        auto mixed = static_cast<std::uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(mixed >> 32) & (shard_count_ - 1);
+    }
+
+    // Must hold s.mutex exclusively.
+    void store(shard& s, const K& key, V value) {
+        size_t weight = weigher_(key, value);
+        auto existing = s.index.find(key);
+        if (weight > s.capacity) {
+            if (existing != s.index.end()) {
+                release(s, existing);
+            }
+            return;
+        }
+
+        if (existing != s.index.end()) {
+            slot& entry = s.slots[existing->second];
+            s.weight -= entry.weight;
+            entry.value = std::move(value);
+            entry.weight = weight;
+            touch(entry);
+            s.weight += weight;
+            evict(s, existing->second);
+            return;
+        }
+
+        evict_for(s, weight);
+        size_t position;
+        if (s.free_slots.empty()) {
+            position = s.slots.size();
+            s.slots.emplace_back();
+        } else {
+            position = s.free_slots.back();
+            s.free_slots.pop_back();
+        }
+        auto inserted = s.index.emplace(key, position).first;
+        slot& entry = s.slots[position];
+        entry.key = &inserted->first;
+        entry.value = std::move(value);
+        entry.weight = weight;
+        // New entries start unreferenced: one-hit wonders are the first to go.
+        entry.referenced.store(false, std::memory_order_relaxed);
+        s.weight += weight;
+    }
+
+    // Evicts until `incoming` more units fit. Must hold s.mutex exclusively.
+    void evict_for(shard& s, size_t incoming) {
+        while (s.weight + incoming > s.capacity && !s.index.empty()) {
+            evict_one(s, s.slots.size());
+        }
+    }
+
+    // After an entry grew in place, evicts others until the shard fits again; `keep` is never evicted.
+    void evict(shard& s, size_t keep) {
+        while (s.weight > s.capacity && s.index.size() > 1) {
+            evict_one(s, keep);
+        }
+    }
+
+    // Advances the clock hand to the first unreferenced entry (other than `keep`) and evicts it.
+    void evict_one(shard& s, size_t keep) {
+        for (;;) {
+            if (s.hand >= s.slots.size()) {
+                s.hand = 0;
+            }
+            size_t position = s.hand++;
+            slot& entry = s.slots[position];
+            if (entry.key == nullptr || position == keep) {
+                continue;
+            }
+            if (entry.referenced.load(std::memory_order_relaxed)) {
+                entry.referenced.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            release(s, s.index.find(*entry.key));
+            s.stats.evictions.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // Must hold s.mutex exclusively.
+    void release(shard& s, typename index_type::iterator it) {
+        size_t position = it->second;
+        slot& entry = s.slots[position];
+        s.weight -= entry.weight;
+        entry.key = nullptr;
+        entry.value.reset();
+        entry.weight = 0;
+        s.index.erase(it);
+        s.free_slots.push_back(position);
+    }
+
+    size_t shard_count_;
+    size_t capacity_;
+    Hash hash_;
+    Weigher weigher_;
+    std::unique_ptr<shard[]> shards_;
+};
+
+} // namespace ts
+
+#endif // TS_LRU_CACHE_H
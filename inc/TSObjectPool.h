@@ -0,0 +1,379 @@
+#ifndef TS_OBJECT_POOL_H
+#define TS_OBJECT_POOL_H
+
+#include "TSCommon.h"
+#include "TSLock.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+
+namespace ts {
+
+/**
+ * @brief Pool of reusable objects with per-thread caches in front of a lock-free free list.
+ *
+ * acquire() hands out an idle object (constructing a new one only when none is idle) as a
+ * move-only handle; destroying the handle returns the object to the pool. Objects are not
+ * reset on the way back: a recycled std::vector keeps its contents and its capacity, which
+ * is usually the point, so clear what needs clearing after acquire().
+ *
+ * Every thread works through a small cache of idle objects (one per thread_slot(), shared
+ * by threads that map to the same cache), so an acquire/release round-trip on one thread
+ * touches no shared cache line. Caches overflow into, and refill from, a shared free list:
+ * a Treiber stack of slot indices tagged with a version counter, so a pop that raced with
+ * other pops and pushes of the same slot fails its CAS instead of corrupting the list (ABA).
+ *
+ * Objects live in place in exponentially growing segments that are only freed with the
+ * pool, so a slot index stays valid for the pool's lifetime and the free list never reads
+ * freed memory. trim() destroys idle objects (and whatever they own) but keeps their slots.
+ *
+ * The pool must outlive every handle taken from it.
+ */
+template <typename T>
+class object_pool {
+public:
+    /**
+     * @brief An object on loan from the pool; returns it on destruction.
+     */
+    class handle {
+    public:
+        handle() = default;
+
+        handle(handle&& other) noexcept
+            : pool_(std::exchange(other.pool_, nullptr)), index_(other.index_), object_(other.object_) {}
+
+        handle& operator=(handle&& other) noexcept {
+            if (this != &other) {
+                reset();
+                pool_ = std::exchange(other.pool_, nullptr);
+                index_ = other.index_;
+                object_ = other.object_;
+            }
+            return *this;
+        }
+
+        ~handle() {
+            reset();
+        }
+
+        NO_DISCARD T& operator*() const noexcept {
+            return *object_;
+        }
+
+        NO_DISCARD T* operator->() const noexcept {
+            return object_;
+        }
+
+        NO_DISCARD T* get() const noexcept {
+            return pool_ != nullptr ? object_ : nullptr;
+        }
+
+        explicit operator bool() const noexcept {
+            return pool_ != nullptr;
+        }
+
+        /**
+         * @brief Returns the object to the pool now; the handle becomes empty.
+         */
+        void reset() noexcept {
+            if (pool_ != nullptr) {
+                std::exchange(pool_, nullptr)->release(index_);
+            }
+        }
+
+    private:
+        friend class object_pool;
+
+        handle(object_pool* pool, std::uint32_t index, T* object) : pool_(pool), index_(index), object_(object) {}
+
+        object_pool* pool_ = nullptr;
+        std::uint32_t index_ = 0;
+        T* object_ = nullptr;
+    };
+
+    /**
+     * @brief Creates a pool with `preallocate` default-constructed idle objects.
+     */
+    explicit object_pool(size_t preallocate = 0)
+        : cache_count_(detail::round_up_pow2(size_t{2} * std::max(1u, std::thread::hardware_concurrency()))),
+          caches_(std::make_unique<cache[]>(cache_count_)) {
+        for (size_t i = 0; i < preallocate; ++i) {
+            std::uint32_t index = take_empty_slot();
+            construct(index);
+            push(idle_, index, index, 1);
+        }
+        low_water_.store(idle_count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    object_pool(const object_pool&) = delete;
+    object_pool& operator=(const object_pool&) = delete;
+
+    ~object_pool() {
+        for (size_t k = 0; k < max_segments; ++k) {
+            slot* segment = segments_[k].load(std::memory_order_acquire);
+            if (segment == nullptr) {
+                continue;
+            }
+            for (size_t i = 0; i < segment_size(k); ++i) {
+                if (segment[i].live) {
+                    segment[i].get()->~T();
+                }
+            }
+            ::operator delete(segment, std::align_val_t{alignof(slot)});
+        }
+    }
+
+    /**
+     * @brief Takes an idle object, or default-constructs a new one if none is idle.
+     */
+    NO_DISCARD handle acquire() {
+        std::uint32_t index = take_from_cache();
+        if (index == no_slot) {
+            index = pop(idle_);
+            if (index != no_slot) {
+                note_idle_pop();
+            } else {
+                index = take_empty_slot();
+                try {
+                    construct(index);
+                } catch (...) {
+                    push(empty_, index, index, 1);
+                    throw;
+                }
+            }
+        }
+        return handle(this, index, slot_at(index).get());
+    }
+
+    /**
+     * @brief Destroys the idle objects that were never needed since the previous trim().
+     *
+     * The shared free list's low-water mark since the last trim() is the number of objects
+     * that sat idle the whole time: peak demand never reached them. Those are destroyed and
+     * the mark restarts from the current idle count, so calling trim() periodically shrinks
+     * the pool to the high-water mark of concurrent use over the last period. Objects in the
+     * per-thread caches are not touched; each cache holds at most a few dozen.
+     *
+     * Returns the number of objects destroyed.
+     */
+    size_t trim() {
+        std::lock_guard lock(trim_mutex_);
+        std::int64_t surplus = low_water_.load(std::memory_order_relaxed);
+        size_t destroyed = 0;
+        for (; surplus > 0; --surplus) {
+            std::uint32_t index = pop(idle_);
+            if (index == no_slot) {
+                break;
+            }
+            note_idle_pop();
+            destroy(index);
+            push(empty_, index, index, 1);
+            ++destroyed;
+        }
+        low_water_.store(idle_count_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return destroyed;
+    }
+
+    /**
+     * @brief Number of constructed objects, in use or idle.
+     */
+    NO_DISCARD size_t live() const noexcept {
+        return live_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Number of idle objects on the shared free list (excluding per-thread caches).
+     */
+    NO_DISCARD size_t idle() const noexcept {
+        return static_cast<size_t>(std::max<std::int64_t>(idle_count_.load(std::memory_order_relaxed), 0));
+    }
+
+private:
+    static constexpr std::uint32_t no_slot = std::numeric_limits<std::uint32_t>::max();
+    static constexpr size_t cache_capacity = 32;
+
+    struct slot {
+        std::atomic<std::uint32_t> next{no_slot};
+        // Only read or written by the slot's current owner (a handle, a cache, or a list pop).
+        bool live = false;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* get() noexcept {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+    // Head of a Treiber stack: slot index in the low half, version tag in the high half.
+    struct alignas(detail::cache_line_size) free_list {
+        std::atomic<std::uint64_t> head{no_slot};
+    };
+
+    struct alignas(detail::cache_line_size) cache {
+        spinlock mutex;
+        size_t count = 0;
+        std::array<std::uint32_t, cache_capacity> slots;
+    };
+
+    static constexpr size_t first_segment_shift = 5;
+    static constexpr size_t first_segment_size = size_t{1} << first_segment_shift;
+    // Keeps every index below no_slot.
+    static constexpr size_t max_segments = 32 - first_segment_shift;
+
+    // Same layout as ts::concurrent_vector: 32, 32, 64, 128, ... slots.
+    static size_t segment_of(size_t index) {
+        return static_cast<size_t>(std::bit_width(index >> first_segment_shift));
+    }
+
+    static size_t segment_start(size_t k) {
+        return k == 0 ? 0 : first_segment_size << (k - 1);
+    }
+
+    static size_t segment_size(size_t k) {
+        return k == 0 ? first_segment_size : first_segment_size << (k - 1);
+    }
+
+    slot& slot_at(std::uint32_t index) const {
+        size_t k = segment_of(index);
+        return segments_[k].load(std::memory_order_acquire)[index - segment_start(k)];
+    }
+
+    static std::uint32_t index_of(std::uint64_t head) {
+        return static_cast<std::uint32_t>(head);
+    }
+
+    static std::uint64_t tagged(std::uint64_t previous, std::uint32_t index) {
+        return ((previous >> 32) + 1) << 32 | index;
+    }
+
+    // Pushes the chain first -> ... -> last, already linked through `next`.
+    void push(free_list& list, std::uint32_t first, std::uint32_t last, size_t count) {
+        std::uint64_t head = list.head.load(std::memory_order_relaxed);
+        do {
+            slot_at(last).next.store(index_of(head), std::memory_order_relaxed);
+        } while (!list.head.compare_exchange_weak(head, tagged(head, first), std::memory_order_release,
+                                                  std::memory_order_relaxed));
+        if (&list == &idle_) {
+            idle_count_.fetch_add(static_cast<std::int64_t>(count), std::memory_order_relaxed);
+        }
+    }
+
+    std::uint32_t pop(free_list& list) {
+        std::uint64_t head = list.head.load(std::memory_order_acquire);
+        for (;;) {
+            std::uint32_t index = index_of(head);
+            if (index == no_slot) {
+                return no_slot;
+            }
+            // The slot may be popped and pushed again meanwhile; then `next` is stale but the
+            // tag has moved on and the CAS fails.
+            std::uint32_t next = slot_at(index).next.load(std::memory_order_relaxed);
+            if (list.head.compare_exchange_weak(head, tagged(head, next), std::memory_order_acquire,
+                                                std::memory_order_acquire)) {
+                return index;
+            }
+        }
+    }
+
+    void note_idle_pop() {
+        std::int64_t now = idle_count_.fetch_sub(1, std::memory_order_relaxed) - 1;
+        std::int64_t low = low_water_.load(std::memory_order_relaxed);
+        while (now < low && !low_water_.compare_exchange_weak(low, now, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::uint32_t take_from_cache() {
+        cache& local = caches_[detail::thread_slot() & (cache_count_ - 1)];
+        std::lock_guard lock(local.mutex);
+        return local.count != 0 ? local.slots[--local.count] : no_slot;
+    }
+
+    void release(std::uint32_t index) noexcept {
+        cache& local = caches_[detail::thread_slot() & (cache_count_ - 1)];
+        std::lock_guard lock(local.mutex);
+        if (local.count == cache_capacity) {
+            // Hand the older half to the shared list in one CAS, keep the recent (warm) half.
+            size_t moved = cache_capacity / 2;
+            for (size_t i = 0; i + 1 < moved; ++i) {
+                slot_at(local.slots[i]).next.store(local.slots[i + 1], std::memory_order_relaxed);
+            }
+            push(idle_, local.slots[0], local.slots[moved - 1], moved);
+            std::copy(local.slots.begin() + moved, local.slots.end(), local.slots.begin());
+            local.count -= moved;
+        }
+        local.slots[local.count++] = index;
+    }
+
+    // Returns a slot without an object, allocating a new segment if none is left.
+    std::uint32_t take_empty_slot() {
+        std::uint32_t index = pop(empty_);
+        if (index != no_slot) {
+            return index;
+        }
+
+        std::lock_guard lock(grow_mutex_);
+        // Another thread may have grown the pool while this one waited.
+        index = pop(empty_);
+        if (index != no_slot) {
+            return index;
+        }
+        if (segment_count_ == max_segments) {
+            throw std::bad_alloc();
+        }
+        size_t k = segment_count_++;
+        size_t count = segment_size(k);
+        auto* segment = static_cast<slot*>(::operator new(count * sizeof(slot), std::align_val_t{alignof(slot)}));
+        for (size_t i = 0; i < count; ++i) {
+            new (&segment[i]) slot();
+        }
+        segments_[k].store(segment, std::memory_order_release);
+
+        auto first = static_cast<std::uint32_t>(segment_start(k));
+        auto last = static_cast<std::uint32_t>(first + count - 1);
+        if (count > 1) {
+            for (std::uint32_t i = first + 1; i < last; ++i) {
+                slot_at(i).next.store(i + 1, std::memory_order_relaxed);
+            }
+            push(empty_, first + 1, last, count - 1);
+        }
+        return first;
+    }
+
+    void construct(std::uint32_t index) {
+        slot& target = slot_at(index);
+        new (target.storage) T();
+        target.live = true;
+        live_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void destroy(std::uint32_t index) {
+        slot& target = slot_at(index);
+        target.get()->~T();
+        target.live = false;
+        live_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    const size_t cache_count_;
+    std::unique_ptr<cache[]> caches_;
+    free_list idle_;
+    free_list empty_;
+    alignas(detail::cache_line_size) std::atomic<std::int64_t> idle_count_{0};
+    std::atomic<std::int64_t> low_water_{0};
+    std::atomic<size_t> live_{0};
+    std::mutex grow_mutex_;
+    std::mutex trim_mutex_;
+    size_t segment_count_ = 0;
+    mutable std::array<std::atomic<slot*>, max_segments> segments_{};
+};
+
+} // namespace ts
+
+#endif // TS_OBJECT_POOL_H
@@ -0,0 +1,490 @@
+#ifndef TS_ORDERED_MAP_H
+#define TS_ORDERED_MAP_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "TSCommon.h"
+#include "TSEpoch.h"
+#include "TSLock.h"
+
+namespace ts {
+
+/**
+ * @brief Concurrent sorted map built on a lazy skip list.
+ *
+ * Lookups and scans never lock: they walk the list inside an epoch guard (see TSEpoch.h),
+ * so a range scan runs alongside inserts and erases instead of blocking them. Writers lock
+ * only the handful of nodes around the key they change, so writers on different parts of
+ * the key space do not contend either.
+ *
+ * Erasing first marks a node (logical removal), then unlinks it; the node and its value are
+ * freed once no reader can still be looking at them. Values are immutable once published:
+ * insert_or_assign() swaps in a new value object, so readers never see a half-written value.
+ *
+ * Scans (for_each, for_each_range, lower_bound) are weakly consistent: they see every key
+ * that was present for the whole scan and may or may not see keys inserted or erased meanwhile.
+ */
+template <typename K, typename V, typename Compare = std::less<K>>
+class ordered_map {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using key_compare = Compare;
+
+    explicit ordered_map(const Compare& compare = Compare()) : compare_(compare), head_(node::create_head()) {}
+
+    ordered_map(const ordered_map&) = delete;
+    ordered_map& operator=(const ordered_map&) = delete;
+
+    // No reader or writer may be active any more, so nodes are deleted rather than retired.
+    ~ordered_map() {
+        node* current = head_;
+        while (current != nullptr) {
+            node* next = current->next(0).load(std::memory_order_relaxed);
+            node::destroy(current);
+            current = next;
+        }
+    }
+
+    /**
+     * @brief Inserts `key` with `value` if the key is absent. Returns true if it inserted.
+     */
+    bool insert(K key, V value) {
+        return insert_impl(std::move(key), std::move(value), false);
+    }
+
+    /**
+     * @brief Inserts `key` or replaces its value. Returns true if the key was new.
+     */
+    bool insert_or_assign(K key, V value) {
+        return insert_impl(std::move(key), std::move(value), true);
+    }
+
+    /**
+     * @brief Removes `key`. Returns true if this call removed it.
+     */
+    bool erase(const K& key) {
+        detail::epoch_guard guard;
+        std::array<node*, max_height> preds;
+        std::array<node*, max_height> succs;
+        node* victim = nullptr;
+        bool marked = false;
+        int top = 0;
+
+        for (;;) {
+            int found = find_position(key, preds, succs);
+            if (!marked) {
+                // A node that is not fully linked, or found below its top level, is still being
+                // inserted; like a marked one it does not count as present.
+                if (found == -1) {
+                    return false;
+                }
+                victim = succs[found];
+                if (!victim->fully_linked.load(std::memory_order_acquire) || victim->top_level != found ||
+                    victim->marked.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                top = victim->top_level;
+                victim->lock.lock();
+                if (victim->marked.load(std::memory_order_relaxed)) {
+                    victim->lock.unlock();
+                    return false;
+                }
+                victim->marked.store(true, std::memory_order_release);
+                marked = true;
+            }
+
+            int locked = -1;
+            if (!lock_predecessors(preds, succs, top, victim, locked)) {
+                unlock_predecessors(preds, locked);
+                continue;
+            }
+            for (int level = top; level >= 0; --level) {
+                preds[level]->next(level).store(victim->next(level).load(std::memory_order_relaxed),
+                                                std::memory_order_release);
+            }
+            victim->lock.unlock();
+            unlock_predecessors(preds, top);
+
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            detail::epoch_domain::instance().retire(victim, [](void* retired) {
+                node::destroy(static_cast<node*>(retired));
+            });
+            return true;
+        }
+    }
+
+    /**
+     * @brief Returns a copy of the value stored under `key`, or std::nullopt. Lock-free.
+     */
+    NO_DISCARD std::optional<V> find(const K& key) const {
+        detail::epoch_guard guard;
+        const node* match = find_live(key);
+        if (match == nullptr) {
+            return std::nullopt;
+        }
+        return *match->value.load(std::memory_order_acquire);
+    }
+
+    NO_DISCARD bool contains(const K& key) const {
+        detail::epoch_guard guard;
+        return find_live(key) != nullptr;
+    }
+
+    /**
+     * @brief The first entry whose key is not less than `key`, or std::nullopt. Lock-free.
+     */
+    NO_DISCARD std::optional<std::pair<K, V>> lower_bound(const K& key) const {
+        detail::epoch_guard guard;
+        for (const node* current = first_not_less(key); current != nullptr;
+             current = current->next(0).load(std::memory_order_acquire)) {
+            if (current->live()) {
+                return std::pair<K, V>(current->key(), *current->value.load(std::memory_order_acquire));
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Calls `callback(const K&, const V&)` for every key in [lo, hi), in order, without blocking writers.
+     *
+     * Weakly consistent (see the class comment). The scan holds an epoch guard, so memory
+     * erased meanwhile is only reclaimed after the scan ends.
+     *
+     * ⚠️ Do not store references after this call — the entries may be freed afterwards.
+     */
+    template <typename F>
+    void for_each_range(const K& lo, const K& hi, F&& callback) const {
+        detail::epoch_guard guard;
+        for (const node* current = first_not_less(lo);
+             current != nullptr && compare_(current->key(), hi);
+             current = current->next(0).load(std::memory_order_acquire)) {
+            if (current->live()) {
+                callback(current->key(), std::as_const(*current->value.load(std::memory_order_acquire)));
+            }
+        }
+    }
+
+    /**
+     * @brief Calls `callback(const K&, const V&)` for every entry, in order, without blocking writers.
+     *
+     * ⚠️ Do not store references after this call — the entries may be freed afterwards.
+     */
+    template <typename F>
+    void for_each(F&& callback) const {
+        detail::epoch_guard guard;
+        for (const node* current = head_->next(0).load(std::memory_order_acquire); current != nullptr;
+             current = current->next(0).load(std::memory_order_acquire)) {
+            if (current->live()) {
+                callback(current->key(), std::as_const(*current->value.load(std::memory_order_acquire)));
+            }
+        }
+    }
+
+    /**
+     * @brief Sorted copy of the entries (weakly consistent, like for_each()).
+     */
+    NO_DISCARD std::vector<std::pair<K, V>> snapshot() const {
+        std::vector<std::pair<K, V>> result;
+        result.reserve(size());
+        for_each([&](const K& key, const V& value) { result.emplace_back(key, value); });
+        return result;
+    }
+
+    /**
+     * @brief Number of entries; exact only when no writer is active.
+     */
+    NO_DISCARD size_t size() const noexcept {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    NO_DISCARD bool empty() const noexcept {
+        return size() == 0;
+    }
+
+private:
+    // Supports about 2^32 entries at the expected search cost.
+    static constexpr int max_height = 32;
+
+    struct node;
+    using link = std::atomic<node*>;
+
+    // Followed in memory by `top_level + 1` links. The head has no key and max_height links.
+    struct node {
+        static node* create_head() {
+            return allocate(max_height - 1);
+        }
+
+        // The value is stored when the node is published.
+        static node* create(int top_level, K&& key) {
+            node* created = allocate(top_level);
+            try {
+                ::new (created->key_storage) K(std::move(key));
+            } catch (...) {
+                release(created);
+                throw;
+            }
+            created->has_key = true;
+            return created;
+        }
+
+        static void destroy(node* n) {
+            delete n->value.load(std::memory_order_relaxed);
+            if (n->has_key) {
+                n->key_ptr()->~K();
+            }
+            release(n);
+        }
+
+        const K& key() const {
+            return *std::launder(reinterpret_cast<const K*>(key_storage));
+        }
+
+        link& next(int level) {
+            return links()[level];
+        }
+
+        const link& next(int level) const {
+            return const_cast<node*>(this)->links()[level];
+        }
+
+        bool live() const {
+            return fully_linked.load(std::memory_order_acquire) && !marked.load(std::memory_order_acquire);
+        }
+
+        int top_level = 0;
+        bool has_key = false;
+        std::atomic<bool> marked{false};
+        std::atomic<bool> fully_linked{false};
+        spinlock lock;
+        std::atomic<const V*> value{nullptr};
+        alignas(K) unsigned char key_storage[sizeof(K)];
+
+    private:
+        static node* allocate(int top_level) {
+            void* raw = ::operator new(links_offset() + sizeof(link) * static_cast<size_t>(top_level + 1),
+                                       std::align_val_t{alignof(node)});
+            node* created = ::new (raw) node;
+            created->top_level = top_level;
+            for (int level = 0; level <= top_level; ++level) {
+                ::new (&created->raw_links()[level]) link(nullptr);
+            }
+            return created;
+        }
+
+        static void release(node* n) {
+            n->~node();
+            ::operator delete(n, std::align_val_t{alignof(node)});
+        }
+
+        K* key_ptr() {
+            return std::launder(reinterpret_cast<K*>(key_storage));
+        }
+
+        link* raw_links() {
+            return reinterpret_cast<link*>(reinterpret_cast<std::byte*>(this) + links_offset());
+        }
+
+        link* links() {
+            return std::launder(raw_links());
+        }
+
+        static constexpr size_t links_offset() {
+            return (sizeof(node) + alignof(link) - 1) / alignof(link) * alignof(link);
+        }
+    };
+
+    static int random_level() {
+        thread_local std::uint64_t state =
+            (0x9E3779B97F4A7C15ull * (detail::thread_slot() + 1)) | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Geometric with p = 1/2: level k with probability 2^-(k+1).
+        return std::countr_zero(state | (std::uint64_t{1} << (max_height - 1)));
+    }
+
+    bool less(const K& a, const K& b) const {
+        return compare_(a, b);
+    }
+
+    // Fills preds/succs on every level below the current height and returns the highest level
+    // on which a node with `key` was found, or -1. Must be called inside an epoch guard.
+    int find_position(const K& key, std::array<node*, max_height>& preds, std::array<node*, max_height>& succs) const {
+        int found = -1;
+        node* pred = head_;
+        for (int level = height_.load(std::memory_order_acquire) - 1; level >= 0; --level) {
+            node* current = pred->next(level).load(std::memory_order_acquire);
+            while (current != nullptr && less(current->key(), key)) {
+                pred = current;
+                current = pred->next(level).load(std::memory_order_acquire);
+            }
+            if (found == -1 && current != nullptr && !less(key, current->key())) {
+                found = level;
+            }
+            preds[level] = pred;
+            succs[level] = current;
+        }
+        return found;
+    }
+
+    // The live node holding `key`, or nullptr. Must be called inside an epoch guard.
+    const node* find_live(const K& key) const {
+        const node* pred = head_;
+        for (int level = height_.load(std::memory_order_acquire) - 1; level >= 0; --level) {
+            const node* current = pred->next(level).load(std::memory_order_acquire);
+            while (current != nullptr && less(current->key(), key)) {
+                pred = current;
+                current = pred->next(level).load(std::memory_order_acquire);
+            }
+            if (current != nullptr && !less(key, current->key())) {
+                return current->live() ? current : nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    // First node (live or not) whose key is not less than `key`. Must be called inside an epoch guard.
+    const node* first_not_less(const K& key) const {
+        const node* pred = head_;
+        const node* current = nullptr;
+        for (int level = height_.load(std::memory_order_acquire) - 1; level >= 0; --level) {
+            current = pred->next(level).load(std::memory_order_acquire);
+            while (current != nullptr && less(current->key(), key)) {
+                pred = current;
+                current = pred->next(level).load(std::memory_order_acquire);
+            }
+        }
+        return current;
+    }
+
+    // Locks the distinct predecessors on levels [0, top] and checks that each still links to
+    // `succs[level]` (or `victim` when erasing) and that neither side is being removed. `locked`
+    // is set to the highest level whose predecessor is held; on failure the caller unlocks and retries.
+    bool lock_predecessors(std::array<node*, max_height>& preds, std::array<node*, max_height>& succs, int top,
+                           node* victim, int& locked) {
+        node* previous = nullptr;
+        for (int level = 0; level <= top; ++level) {
+            node* pred = preds[level];
+            node* succ = victim != nullptr ? victim : succs[level];
+            if (pred != previous) {
+                pred->lock.lock();
+                previous = pred;
+            }
+            locked = level;
+            bool valid = !pred->marked.load(std::memory_order_acquire) &&
+                         pred->next(level).load(std::memory_order_acquire) == succ &&
+                         (victim != nullptr || succ == nullptr || !succ->marked.load(std::memory_order_acquire));
+            if (!valid) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Unlocks the distinct predecessors on levels [0, top].
+    static void unlock_predecessors(std::array<node*, max_height>& preds, int top) {
+        node* previous = nullptr;
+        for (int level = 0; level <= top; ++level) {
+            if (preds[level] != previous) {
+                preds[level]->lock.unlock();
+                previous = preds[level];
+            }
+        }
+    }
+
+    void raise_height(int top_level) {
+        int height = height_.load(std::memory_order_relaxed);
+        while (height <= top_level &&
+               !height_.compare_exchange_weak(height, top_level + 1, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool insert_impl(K&& key, V&& value, bool assign) {
+        detail::epoch_guard guard;
+        std::array<node*, max_height> preds;
+        std::array<node*, max_height> succs;
+        int top = random_level();
+        // Raised first, so that the searches below fill preds/succs up to `top`.
+        raise_height(top);
+        // Allocated at most once, outside any lock, and kept across retries.
+        std::unique_ptr<node, void (*)(node*)> fresh(nullptr, &node::destroy);
+        std::unique_ptr<V> boxed;
+
+        for (;;) {
+            const K& search = fresh ? fresh->key() : key;
+            int found = find_position(search, preds, succs);
+            if (found != -1) {
+                node* existing = succs[found];
+                if (existing->marked.load(std::memory_order_acquire)) {
+                    // Being erased; retry once it is unlinked.
+                    std::this_thread::yield();
+                    continue;
+                }
+                while (!existing->fully_linked.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                if (!assign) {
+                    return false;
+                }
+                if (!boxed) {
+                    boxed = std::make_unique<V>(std::move(value));
+                }
+                {
+                    std::lock_guard lock(existing->lock);
+                    if (!existing->marked.load(std::memory_order_relaxed)) {
+                        detail::retire_delete(existing->value.exchange(boxed.release(), std::memory_order_acq_rel));
+                        return false;
+                    }
+                }
+                // Erased meanwhile: insert a new node instead.
+                continue;
+            }
+
+            if (!boxed) {
+                boxed = std::make_unique<V>(std::move(value));
+            }
+            if (!fresh) {
+                fresh.reset(node::create(top, std::move(key)));
+            }
+            int locked = -1;
+            if (!lock_predecessors(preds, succs, top, nullptr, locked)) {
+                unlock_predecessors(preds, locked);
+                continue;
+            }
+            node* created = fresh.release();
+            created->value.store(boxed.release(), std::memory_order_relaxed);
+            for (int level = 0; level <= top; ++level) {
+                created->next(level).store(succs[level], std::memory_order_relaxed);
+            }
+            for (int level = 0; level <= top; ++level) {
+                preds[level]->next(level).store(created, std::memory_order_release);
+            }
+            created->fully_linked.store(true, std::memory_order_release);
+            unlock_predecessors(preds, top);
+            size_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    Compare compare_;
+    node* head_;
+    std::atomic<int> height_{1};
+    alignas(detail::cache_line_size) std::atomic<size_t> size_{0};
+};
+
+} // namespace ts
+
+#endif // TS_ORDERED_MAP_H
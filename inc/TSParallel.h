@@ -0,0 +1,186 @@
+#ifndef TS_PARALLEL_H
+#define TS_PARALLEL_H
+
+#include "TSCommon.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ts {
+
+/**
+ * @brief Opt-in parallel execution for bulk operations such as ts::vector::erase_if.
+ *
+ * Containers with at least `threshold` elements split the work into chunks that run on a
+ * shared thread pool (plus the calling thread); smaller ones run sequentially, where the
+ * hand-off would cost more than it saves. `max_threads` caps the number of threads working
+ * on one call, 0 meaning all of them.
+ *
+ * Callbacks passed together with a parallel_policy are invoked concurrently on different
+ * elements, so they must not share unsynchronised state.
+ */
+struct parallel_policy {
+    size_t threshold = size_t{1} << 16;
+    unsigned max_threads = 0;
+};
+
+namespace detail {
+
+/**
+ * @brief Process-wide fork-join pool behind parallel_policy.
+ *
+ * Workers are started on first use (hardware_concurrency - 1 of them) and live until exit;
+ * the pool is intentionally leaked so that static destruction order never matters. The
+ * calling thread always takes part in its own job, so nested parallel calls cannot deadlock.
+ */
+class thread_pool {
+public:
+    static thread_pool& instance() {
+        static thread_pool* pool = new thread_pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return *pool;
+    }
+
+    NO_DISCARD unsigned thread_count() const {
+        return static_cast<unsigned>(workers_.size()) + 1;
+    }
+
+    /**
+     * @brief Calls `task(i)` for every i in [0, count) on up to `max_threads` threads and waits.
+     *
+     * The first exception thrown by a task is rethrown here once every task has finished.
+     */
+    template <class F>
+    void parallel_for(size_t count, unsigned max_threads, F&& task) {
+        unsigned helpers = std::min<unsigned>(max_threads == 0 ? thread_count() : max_threads, thread_count()) - 1;
+        helpers = static_cast<unsigned>(std::min<size_t>(helpers, count == 0 ? 0 : count - 1));
+        if (helpers == 0) {
+            for (size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        job current;
+        current.count = count;
+        current.context = &task;
+        current.run = [](void* context, size_t index) { (*static_cast<std::remove_reference_t<F>*>(context))(index); };
+        current.seats = helpers;
+
+        {
+            std::lock_guard lock(mutex_);
+            jobs_.push_back(&current);
+        }
+        work_available_.notify_all();
+
+        work_on(current);
+
+        {
+            // No worker may pick the job up once the caller is done with it.
+            std::lock_guard lock(mutex_);
+            auto it = std::find(jobs_.begin(), jobs_.end(), &current);
+            if (it != jobs_.end()) {
+                jobs_.erase(it);
+            }
+        }
+        while (current.active.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+
+        if (current.error) {
+            std::rethrow_exception(current.error);
+        }
+    }
+
+private:
+    struct job {
+        std::atomic<size_t> next{0};
+        size_t count = 0;
+        void* context = nullptr;
+        void (*run)(void*, size_t) = nullptr;
+        unsigned seats = 0;
+        std::atomic<unsigned> active{0};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    explicit thread_pool(unsigned workers) {
+        workers_.reserve(workers);
+        for (unsigned i = 0; i < workers; ++i) {
+            workers_.emplace_back([this] { worker_loop(); });
+            workers_.back().detach();
+        }
+    }
+
+    static void work_on(job& current) {
+        for (size_t index; (index = current.next.fetch_add(1, std::memory_order_relaxed)) < current.count;) {
+            try {
+                current.run(current.context, index);
+            } catch (...) {
+                std::lock_guard lock(current.error_mutex);
+                if (!current.error) {
+                    current.error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    [[noreturn]] void worker_loop() {
+        for (;;) {
+            job* current = nullptr;
+            {
+                std::unique_lock lock(mutex_);
+                work_available_.wait(lock, [this] { return !jobs_.empty(); });
+                current = jobs_.front();
+                current->active.fetch_add(1, std::memory_order_relaxed);
+                if (--current->seats == 0) {
+                    jobs_.pop_front();
+                }
+            }
+            work_on(*current);
+            current->active.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable work_available_;
+    std::deque<job*> jobs_;
+    std::vector<std::thread> workers_;
+};
+
+// Splits [0, size) into at most `max_chunks` contiguous, nearly equal chunks.
+struct chunking {
+    chunking(size_t size, size_t max_chunks)
+        : size(size), count(std::max<size_t>(1, std::min(size, max_chunks))) {}
+
+    size_t begin(size_t chunk) const {
+        return size * chunk / count;
+    }
+
+    size_t end(size_t chunk) const {
+        return size * (chunk + 1) / count;
+    }
+
+    size_t size;
+    size_t count;
+};
+
+// Number of chunks a call under `policy` splits `size` elements into; 1 means run sequentially.
+// An explicit max_threads is honoured even beyond the pool size, which then just runs more chunks per thread.
+inline unsigned parallel_width(const parallel_policy& policy, size_t size) {
+    if (size < policy.threshold || size < 2) {
+        return 1;
+    }
+    return policy.max_threads == 0 ? thread_pool::instance().thread_count() : policy.max_threads;
+}
+
+} // namespace detail
+
+} // namespace ts
+
+#endif // TS_PARALLEL_H
@@ -0,0 +1,248 @@
+#ifndef TS_POOL_ALLOCATOR_H
+#define TS_POOL_ALLOCATOR_H
+
+#include "TSCommon.h"
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+namespace ts {
+
+namespace detail {
+
+/**
+ * @brief Process-wide size-class arena behind ts::pool_allocator.
+ *
+ * Requests are rounded up to a power-of-two size class between 16 bytes and 64 KiB.
+ * Each thread keeps an intrusive free list per class; when it runs dry it takes a batch
+ * from the shared list of that class, and the shared list carves new blocks out of large
+ * slabs obtained from ::operator new. Threads hand surplus blocks back in batches, and
+ * return everything they cache when they exit.
+ *
+ * Slabs are never returned to the system, so once a workload has reached its peak
+ * footprint, allocation and deallocation never touch the global allocator again.
+ */
+class pool_arena {
+public:
+    static constexpr std::size_t min_class_shift = 4;
+    static constexpr std::size_t max_class_shift = 16;
+    static constexpr std::size_t class_count = max_class_shift - min_class_shift + 1;
+    static constexpr std::size_t max_block_size = std::size_t{1} << max_class_shift;
+
+    static pool_arena& instance() {
+        // Intentionally leaked: blocks may still be returned by static objects during shutdown.
+        static pool_arena* arena = new pool_arena;
+        return *arena;
+    }
+
+    static std::size_t size_class(std::size_t bytes) {
+        std::size_t shift = min_class_shift;
+        while ((std::size_t{1} << shift) < bytes) {
+            ++shift;
+        }
+        return shift - min_class_shift;
+    }
+
+    static void* allocate(std::size_t bytes) {
+        if (bytes > max_block_size) {
+            return ::operator new(bytes);
+        }
+        if (cache_destroyed) {
+            std::size_t count = 0;
+            block* batch = instance().take_batch(size_class(bytes), count);
+            if (batch->next != nullptr) {
+                instance().give_back(size_class(bytes), batch->next);
+            }
+            return batch;
+        }
+        return local_cache().pop(size_class(bytes));
+    }
+
+    static void deallocate(void* pointer, std::size_t bytes) noexcept {
+        if (bytes > max_block_size) {
+            ::operator delete(pointer);
+            return;
+        }
+        if (cache_destroyed) {
+            auto* released = static_cast<block*>(pointer);
+            released->next = nullptr;
+            instance().give_back(size_class(bytes), released);
+            return;
+        }
+        local_cache().push(size_class(bytes), pointer);
+    }
+
+private:
+    struct block {
+        block* next;
+    };
+
+    struct alignas(cache_line_size) shared_list {
+        std::mutex mutex;
+        block* head = nullptr;
+    };
+
+    static constexpr std::size_t slab_size = 256 * 1024;
+
+    static std::size_t block_size(std::size_t size_class) {
+        return std::size_t{1} << (size_class + min_class_shift);
+    }
+
+    // Fewer, larger transfers for small blocks; never more than a slab's worth.
+    static std::size_t batch_size(std::size_t size_class) {
+        std::size_t blocks_per_slab = slab_size / block_size(size_class);
+        return blocks_per_slab < 32 ? blocks_per_slab : 32;
+    }
+
+    // Objects with static or thread storage may release memory after this thread's cache is gone.
+    static inline thread_local bool cache_destroyed = false;
+
+    struct thread_cache {
+        ~thread_cache() {
+            cache_destroyed = true;
+            for (std::size_t c = 0; c < class_count; ++c) {
+                if (heads[c] != nullptr) {
+                    instance().give_back(c, heads[c]);
+                }
+            }
+        }
+
+        void* pop(std::size_t size_class) {
+            if (heads[size_class] == nullptr) {
+                heads[size_class] = instance().take_batch(size_class, counts[size_class]);
+            }
+            block* result = heads[size_class];
+            heads[size_class] = result->next;
+            --counts[size_class];
+            return result;
+        }
+
+        void push(std::size_t size_class, void* pointer) {
+            auto* released = static_cast<block*>(pointer);
+            released->next = heads[size_class];
+            heads[size_class] = released;
+
+            if (++counts[size_class] > 2 * batch_size(size_class)) {
+                // Keep one batch locally and hand the rest back so cross-thread frees do not pile up here.
+                block* keep_tail = heads[size_class];
+                for (std::size_t i = 1; i < batch_size(size_class); ++i) {
+                    keep_tail = keep_tail->next;
+                }
+                instance().give_back(size_class, keep_tail->next);
+                keep_tail->next = nullptr;
+                counts[size_class] = batch_size(size_class);
+            }
+        }
+
+        std::array<block*, class_count> heads{};
+        std::array<std::size_t, class_count> counts{};
+    };
+
+    static thread_cache& local_cache() {
+        thread_local thread_cache cache;
+        return cache;
+    }
+
+    block* take_batch(std::size_t size_class, std::size_t& count) {
+        shared_list& list = lists_[size_class];
+        std::lock_guard lock(list.mutex);
+
+        if (list.head == nullptr) {
+            list.head = carve_slab(size_class);
+        }
+
+        block* first = list.head;
+        block* last = first;
+        count = 1;
+        while (count < batch_size(size_class) && last->next != nullptr) {
+            last = last->next;
+            ++count;
+        }
+        list.head = last->next;
+        last->next = nullptr;
+        return first;
+    }
+
+    void give_back(std::size_t size_class, block* chain) {
+        block* last = chain;
+        while (last->next != nullptr) {
+            last = last->next;
+        }
+
+        shared_list& list = lists_[size_class];
+        std::lock_guard lock(list.mutex);
+        last->next = list.head;
+        list.head = chain;
+    }
+
+    static block* carve_slab(std::size_t size_class) {
+        std::size_t size = block_size(size_class);
+        auto* slab = static_cast<unsigned char*>(::operator new(slab_size));
+
+        block* head = nullptr;
+        for (std::size_t offset = slab_size; offset >= size; offset -= size) {
+            auto* carved = reinterpret_cast<block*>(slab + offset - size);
+            carved->next = head;
+            head = carved;
+        }
+        return head;
+    }
+
+    std::array<shared_list, class_count> lists_;
+};
+
+} // namespace detail
+
+/**
+ * @brief Stateless allocator backed by a thread-caching size-class pool.
+ *
+ * Usable with any allocator-aware container, including ts::vector and ts::deque:
+ *
+ *     ts::deque<int, ts::pool_allocator<int>> d;
+ *
+ * Blocks up to 64 KiB come from per-thread free lists, so a steady-state push/pop
+ * workload performs no global allocations. Larger requests and over-aligned types
+ * go straight to ::operator new. All instances compare equal, so memory may be freed
+ * from any thread and through any rebound copy.
+ */
+template <typename T>
+class pool_allocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    pool_allocator() noexcept = default;
+
+    template <typename U>
+    pool_allocator(const pool_allocator<U>&) noexcept {}
+
+    NO_DISCARD T* allocate(std::size_t count) {
+        if (count > static_cast<std::size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{alignof(T)}));
+        } else {
+            return static_cast<T*>(detail::pool_arena::allocate(count * sizeof(T)));
+        }
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept {
+        if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            ::operator delete(pointer, std::align_val_t{alignof(T)});
+        } else {
+            detail::pool_arena::deallocate(pointer, count * sizeof(T));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const pool_allocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+} // namespace ts
+
+#endif // TS_POOL_ALLOCATOR_H
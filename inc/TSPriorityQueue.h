@@ -0,0 +1,183 @@
+#ifndef TS_PRIORITY_QUEUE_H
+#define TS_PRIORITY_QUEUE_H
+
+#include "TSCommon.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace ts {
+
+/**
+ * @brief Relaxed concurrent priority queue (MultiQueue).
+ *
+ * Elements are spread over several independently locked binary heaps. push() inserts into a
+ * random heap; try_pop() looks at the tops of two random heaps and removes the better one.
+ * Threads rarely meet on the same lock, at the price of relaxed ordering: a pop returns one
+ * of the highest-priority elements, not necessarily the highest. With c * threads heaps the
+ * expected rank error is O(c * threads).
+ *
+ * As with std::priority_queue, the default std::less<T> makes the largest element the top.
+ */
+template <typename T, typename Compare = std::less<T>>
+class priority_queue {
+public:
+    explicit priority_queue(size_t heap_count = 2 * std::thread::hardware_concurrency(), Compare compare = Compare())
+        : heap_count_(std::max<size_t>(heap_count, 2)),
+          heaps_(std::make_unique<heap[]>(heap_count_)),
+          compare_(std::move(compare)) {}
+
+    priority_queue(const priority_queue&) = delete;
+    priority_queue& operator=(const priority_queue&) = delete;
+
+    ~priority_queue() = default;
+
+    /**
+     * @brief Number of stored elements; only a hint while other threads are pushing or popping.
+     */
+    NO_DISCARD size_t size() const {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    NO_DISCARD bool empty() const {
+        return size() == 0;
+    }
+
+    void push(const T& value) {
+        emplace(value);
+    }
+
+    void push(T&& value) {
+        emplace(std::move(value));
+    }
+
+    template <class... Args>
+    void emplace(Args&&... args) {
+        {
+            std::unique_lock<std::mutex> lock;
+            heap& target = lock_random_heap(lock);
+            target.data.emplace_back(std::forward<Args>(args)...);
+            std::push_heap(target.data.begin(), target.data.end(), compare_);
+            // Counted under the heap lock so a concurrent take_top() can never drive size_ below zero.
+            size_.fetch_add(1, std::memory_order_release);
+        }
+        size_.notify_one();
+    }
+
+    /**
+     * @brief Removes a high-priority element, or returns std::nullopt if the queue is empty.
+     */
+    NO_DISCARD std::optional<T> try_pop() {
+        if (size_.load(std::memory_order_acquire) == 0) {
+            return std::nullopt;
+        }
+
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            size_t first = random_index();
+            size_t second = random_index();
+            if (first == second) {
+                second = (second + 1) % heap_count_;
+            }
+
+            std::unique_lock first_lock(heaps_[first].mutex, std::try_to_lock);
+            std::unique_lock second_lock(heaps_[second].mutex, std::try_to_lock);
+            if (!first_lock || !second_lock) {
+                continue;
+            }
+
+            heap* best = better_heap(&heaps_[first], &heaps_[second]);
+            if (best != nullptr) {
+                return take_top(*best);
+            }
+        }
+
+        // Random probes kept missing; sweep every heap so an element is never overlooked.
+        size_t start = random_index();
+        for (size_t offset = 0; offset < heap_count_; ++offset) {
+            heap& candidate = heaps_[(start + offset) % heap_count_];
+            std::lock_guard lock(candidate.mutex);
+            if (!candidate.data.empty()) {
+                return take_top(candidate);
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Removes a high-priority element, sleeping while the queue is empty.
+     */
+    NO_DISCARD T pop() {
+        for (;;) {
+            if (auto value = try_pop()) {
+                return std::move(*value);
+            }
+            size_.wait(0, std::memory_order_acquire);
+        }
+    }
+
+private:
+    struct alignas(detail::cache_line_size) heap {
+        std::mutex mutex;
+        std::vector<T> data;
+    };
+
+    static std::uint64_t next_random() {
+        thread_local std::uint64_t state = 0x9E3779B97F4A7C15ull * (detail::thread_slot() + 1);
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    size_t random_index() const {
+        return static_cast<size_t>(next_random() % heap_count_);
+    }
+
+    // Prefers an uncontended heap; blocks only if several random picks are all busy.
+    heap& lock_random_heap(std::unique_lock<std::mutex>& lock) {
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            heap& candidate = heaps_[random_index()];
+            lock = std::unique_lock(candidate.mutex, std::try_to_lock);
+            if (lock) {
+                return candidate;
+            }
+        }
+        heap& candidate = heaps_[random_index()];
+        lock = std::unique_lock(candidate.mutex);
+        return candidate;
+    }
+
+    heap* better_heap(heap* first, heap* second) const {
+        if (first->data.empty()) {
+            return second->data.empty() ? nullptr : second;
+        }
+        if (second->data.empty()) {
+            return first;
+        }
+        return compare_(first->data.front(), second->data.front()) ? second : first;
+    }
+
+    T take_top(heap& source) {
+        std::pop_heap(source.data.begin(), source.data.end(), compare_);
+        T value = std::move(source.data.back());
+        source.data.pop_back();
+        size_.fetch_sub(1, std::memory_order_release);
+        return value;
+    }
+
+    const size_t heap_count_;
+    const std::unique_ptr<heap[]> heaps_;
+    Compare compare_;
+    alignas(detail::cache_line_size) std::atomic<size_t> size_{0};
+};
+
+} // namespace ts
+
+#endif // TS_PRIORITY_QUEUE_H
@@ -0,0 +1,159 @@
+#ifndef TS_READ_MOSTLY_VECTOR_H
+#define TS_READ_MOSTLY_VECTOR_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <initializer_list>
+#include <algorithm>
+#include <ranges>
+#include <utility>
+
+#include "TSCommon.h"
+#include "TSEpoch.h"
+#include "TSFilter.h"
+
+namespace ts {
+
+/**
+ * @brief Vector with lock-free readers for data that is read constantly and written rarely.
+ *
+ * The current contents are an immutable std::vector reached through an atomic pointer.
+ * Readers only load that pointer inside an epoch guard (see TSEpoch.h): no lock, no
+ * reference count, and no write to any cache line shared with other readers, so reads
+ * scale with the number of cores.
+ *
+ * Every write copies the current vector, modifies the copy and publishes it with one atomic
+ * store; the old version is freed once no reader can still be looking at it. Writers are
+ * serialised by a mutex and pay O(n) per call, so batch writes with append_range() or
+ * update() where possible.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class read_mostly_vector {
+public:
+    using vector_type = std::vector<T, Allocator>;
+    using allocator_type = Allocator;
+
+    read_mostly_vector() : current_(new vector_type()) {}
+
+    explicit read_mostly_vector(const Allocator& alloc) : current_(new vector_type(alloc)) {}
+
+    explicit read_mostly_vector(vector_type vec) : current_(new vector_type(std::move(vec))) {}
+
+    read_mostly_vector(std::initializer_list<T> init_list) : current_(new vector_type(init_list)) {}
+
+    read_mostly_vector(const read_mostly_vector&) = delete;
+    read_mostly_vector& operator=(const read_mostly_vector&) = delete;
+
+    // No reader may be active any more, so the current version is not retired but deleted.
+    ~read_mostly_vector() {
+        delete current_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Calls `callback` with a const reference to the current version and returns its result.
+     *
+     * Lock-free and zero-copy. The callback sees one consistent version even if writers
+     * publish new ones meanwhile.
+     *
+     * ⚠️ Do not keep references, pointers or iterators past the callback — the version may be freed afterwards.
+     */
+    template <typename F>
+    decltype(auto) read(F&& callback) const {
+        detail::epoch_guard guard;
+        return std::forward<F>(callback)(*current_.load(std::memory_order_acquire));
+    }
+
+    NO_DISCARD size_t size() const {
+        return read([](const vector_type& data) { return data.size(); });
+    }
+
+    NO_DISCARD bool empty() const {
+        return read([](const vector_type& data) { return data.empty(); });
+    }
+
+    NO_DISCARD vector_type snapshot() const {
+        return read([](const vector_type& data) { return data; });
+    }
+
+    /**
+     * @brief Publishes a new version produced by applying `callback` to a copy of the current one.
+     *
+     * Readers see either the old or the new version, never a partial update.
+     */
+    template <typename F>
+    void update(F&& callback) {
+        std::lock_guard lock(write_mutex_);
+        auto next = std::make_unique<vector_type>(*current_.load(std::memory_order_relaxed));
+        std::forward<F>(callback)(*next);
+        publish(next.release());
+    }
+
+    /**
+     * @brief Replaces the contents without copying the current version.
+     */
+    void assign(vector_type vec) {
+        std::lock_guard lock(write_mutex_);
+        publish(new vector_type(std::move(vec)));
+    }
+
+    void clear() {
+        std::lock_guard lock(write_mutex_);
+        publish(new vector_type(current_.load(std::memory_order_relaxed)->get_allocator()));
+    }
+
+    void push_back(const T& value) {
+        update([&](vector_type& data) { data.push_back(value); });
+    }
+
+    void push_back(T&& value) {
+        update([&](vector_type& data) { data.push_back(std::move(value)); });
+    }
+
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        update([&](vector_type& data) { data.emplace_back(std::forward<Args>(args)...); });
+    }
+
+    /**
+     * @brief Appends every element of `range` as one new version.
+     *
+     * Elements of an rvalue container are moved; lvalues and views are copied.
+     */
+    template <std::ranges::input_range R>
+    void append_range(R&& range) {
+        update([&](vector_type& data) {
+            for (auto&& element : range) {
+                if constexpr (detail::owns_movable_elements_v<R&&>) {
+                    data.emplace_back(std::move(element));
+                } else {
+                    data.emplace_back(element);
+                }
+            }
+        });
+    }
+
+    void pop_back() {
+        update([](vector_type& data) { data.pop_back(); });
+    }
+
+    template <typename Pred>
+    void erase_if(Pred pred) {
+        update([&](vector_type& data) { data.erase(detail::filter_remove_if(data.begin(), data.end(), pred), data.end()); });
+    }
+
+private:
+    // Must hold write_mutex_.
+    void publish(vector_type* next) {
+        const vector_type* previous = current_.exchange(next, std::memory_order_acq_rel);
+        detail::retire_delete(previous);
+    }
+
+    std::atomic<const vector_type*> current_;
+    alignas(detail::cache_line_size) std::mutex write_mutex_;
+};
+
+} // namespace ts
+
+#endif // TS_READ_MOSTLY_VECTOR_H
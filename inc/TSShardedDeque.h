@@ -0,0 +1,133 @@
+#ifndef TS_SHARDED_DEQUE_H
+#define TS_SHARDED_DEQUE_H
+
+#include "TSCommon.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace ts {
+
+/**
+ * @brief Relaxed-FIFO queue made of independently locked shards.
+ *
+ * Every thread has a home shard (assigned round-robin the first time it touches any
+ * sharded_deque). Producers only push to their home shard, so with at least as many
+ * shards as producers, pushes do not contend. Consumers pop from their home shard first
+ * and otherwise steal from the other shards in round-robin order.
+ *
+ * Ordering guarantees:
+ *  - Elements pushed by one thread are popped in the order that thread pushed them.
+ *  - There is no ordering between elements pushed by different threads.
+ *  - pop_front_nullable() skips shards that look empty without locking them, so it may
+ *    return std::nullopt while a push on another shard is still in flight.
+ *
+ * size() and empty() lock every shard at once and are exact, but cost O(shard count).
+ */
+template <typename T>
+class sharded_deque {
+public:
+    explicit sharded_deque(size_t shard_count = std::thread::hardware_concurrency())
+        : shard_count_(shard_count == 0 ? 1 : shard_count),
+          shards_(std::make_unique<shard[]>(shard_count_)) {}
+
+    sharded_deque(const sharded_deque&) = delete;
+    sharded_deque& operator=(const sharded_deque&) = delete;
+
+    ~sharded_deque() = default;
+
+    NO_DISCARD size_t shard_count() const {
+        return shard_count_;
+    }
+
+    NO_DISCARD size_t size() const {
+        auto locks = lock_all();
+        size_t total = 0;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            total += shards_[i].data.size();
+        }
+        return total;
+    }
+
+    NO_DISCARD bool empty() const {
+        return size() == 0;
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        shard& home = shards_[home_index()];
+        std::lock_guard lock(home.mutex);
+        home.data.emplace_back(std::forward<Args>(args)...);
+        home.size.store(home.data.size(), std::memory_order_release);
+    }
+
+    NO_DISCARD std::optional<T> pop_front_nullable() {
+        size_t home = home_index();
+        for (size_t offset = 0; offset < shard_count_; ++offset) {
+            shard& candidate = shards_[(home + offset) % shard_count_];
+            if (candidate.size.load(std::memory_order_acquire) == 0) {
+                continue;
+            }
+
+            std::lock_guard lock(candidate.mutex);
+            if (candidate.data.empty()) {
+                continue;
+            }
+
+            T value = std::move(candidate.data.front());
+            candidate.data.pop_front();
+            candidate.size.store(candidate.data.size(), std::memory_order_release);
+            return value;
+        }
+        return std::nullopt;
+    }
+
+    void clear() {
+        auto locks = lock_all();
+        for (size_t i = 0; i < shard_count_; ++i) {
+            shards_[i].data.clear();
+            shards_[i].size.store(0, std::memory_order_release);
+        }
+    }
+
+private:
+    struct alignas(detail::cache_line_size) shard {
+        std::mutex mutex;
+        std::atomic<size_t> size{0};
+        std::deque<T> data;
+    };
+
+    // Shards are always locked in index order, so concurrent lock_all() calls cannot deadlock.
+    std::vector<std::unique_lock<std::mutex>> lock_all() const {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(shard_count_);
+        for (size_t i = 0; i < shard_count_; ++i) {
+            locks.emplace_back(shards_[i].mutex);
+        }
+        return locks;
+    }
+
+    size_t home_index() const {
+        return detail::thread_slot() % shard_count_;
+    }
+
+    const size_t shard_count_;
+    const std::unique_ptr<shard[]> shards_;
+};
+
+} // namespace ts
+
+#endif // TS_SHARDED_DEQUE_H
@@ -0,0 +1,170 @@
+#ifndef TS_SNAPSHOT_POOL_H
+#define TS_SNAPSHOT_POOL_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "TSCommon.h"
+
+namespace ts {
+
+/**
+ * @brief Recycles snapshot buffers so that steady-state snapshots allocate nothing.
+ *
+ * take(container) fills an idle buffer through the container's snapshot_into() and returns
+ * it as a move-only handle; when the handle is destroyed the buffer, with its capacity,
+ * goes back to the pool. Up to `max_idle` buffers are kept, which covers readers that hold
+ * a few snapshots at once.
+ *
+ *     ts::snapshot_pool<int> pool;
+ *     for (;;) {
+ *         auto snap = pool.take(vec);   // no allocation once the buffers have grown
+ *         publish(*snap);
+ *     }
+ *
+ * The pool must outlive every handle taken from it.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class snapshot_pool {
+public:
+    using buffer_type = std::vector<T, Allocator>;
+
+    /**
+     * @brief A pooled buffer; returns itself to the pool on destruction.
+     */
+    class handle {
+    public:
+        handle() = default;
+
+        handle(handle&& other) noexcept
+            : pool_(std::exchange(other.pool_, nullptr)), buffer_(std::move(other.buffer_)) {}
+
+        handle& operator=(handle&& other) noexcept {
+            if (this != &other) {
+                release();
+                pool_ = std::exchange(other.pool_, nullptr);
+                buffer_ = std::move(other.buffer_);
+            }
+            return *this;
+        }
+
+        ~handle() {
+            release();
+        }
+
+        NO_DISCARD buffer_type& operator*() noexcept {
+            return buffer_;
+        }
+
+        NO_DISCARD const buffer_type& operator*() const noexcept {
+            return buffer_;
+        }
+
+        NO_DISCARD buffer_type* operator->() noexcept {
+            return &buffer_;
+        }
+
+        NO_DISCARD const buffer_type* operator->() const noexcept {
+            return &buffer_;
+        }
+
+        NO_DISCARD auto begin() const noexcept {
+            return buffer_.begin();
+        }
+
+        NO_DISCARD auto end() const noexcept {
+            return buffer_.end();
+        }
+
+        NO_DISCARD size_t size() const noexcept {
+            return buffer_.size();
+        }
+
+        NO_DISCARD bool empty() const noexcept {
+            return buffer_.empty();
+        }
+
+        NO_DISCARD const T& operator[](size_t index) const {
+            return buffer_[index];
+        }
+
+    private:
+        friend class snapshot_pool;
+
+        handle(snapshot_pool* pool, buffer_type buffer) : pool_(pool), buffer_(std::move(buffer)) {}
+
+        void release() noexcept {
+            if (pool_ != nullptr) {
+                std::exchange(pool_, nullptr)->give_back(std::move(buffer_));
+            }
+        }
+
+        snapshot_pool* pool_ = nullptr;
+        buffer_type buffer_;
+    };
+
+    explicit snapshot_pool(size_t max_idle = 4, const Allocator& alloc = Allocator())
+        : max_idle_(max_idle), alloc_(alloc) {
+        // Reserved up front so that returning a buffer never allocates.
+        idle_.reserve(max_idle_);
+    }
+
+    snapshot_pool(const snapshot_pool&) = delete;
+    snapshot_pool& operator=(const snapshot_pool&) = delete;
+
+    /**
+     * @brief An empty buffer that keeps the capacity of its previous use.
+     */
+    NO_DISCARD handle acquire() {
+        std::unique_lock lock(mutex_);
+        if (idle_.empty()) {
+            lock.unlock();
+            return handle(this, buffer_type(alloc_));
+        }
+        buffer_type buffer = std::move(idle_.back());
+        idle_.pop_back();
+        lock.unlock();
+
+        buffer.clear();
+        return handle(this, std::move(buffer));
+    }
+
+    /**
+     * @brief Snapshots `source` (ts::vector, ts::deque, ...) into a pooled buffer.
+     */
+    template <typename Source>
+        requires requires(const Source& source, buffer_type& out) { source.snapshot_into(out); }
+    NO_DISCARD handle take(const Source& source) {
+        handle result = acquire();
+        source.snapshot_into(*result);
+        return result;
+    }
+
+    /**
+     * @brief Number of buffers currently waiting for reuse.
+     */
+    NO_DISCARD size_t idle() const {
+        std::lock_guard lock(mutex_);
+        return idle_.size();
+    }
+
+private:
+    void give_back(buffer_type&& buffer) noexcept {
+        std::lock_guard lock(mutex_);
+        if (idle_.size() < max_idle_) {
+            idle_.push_back(std::move(buffer));
+        }
+        // Otherwise the buffer is freed when the handle is destroyed.
+    }
+
+    size_t max_idle_;
+    Allocator alloc_;
+    mutable std::mutex mutex_;
+    std::vector<buffer_type> idle_;
+};
+
+} // namespace ts
+
+#endif // TS_SNAPSHOT_POOL_H
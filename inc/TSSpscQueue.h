@@ -0,0 +1,385 @@
+#ifndef TS_SPSC_QUEUE_H
+#define TS_SPSC_QUEUE_H
+
+#include "TSCommon.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+
+namespace ts {
+
+/**
+ * @brief Wait-free bounded single-producer / single-consumer FIFO queue.
+ *
+ * Exactly one thread may push and exactly one (other) thread may pop. Each side owns
+ * its index on a separate cache line and keeps a cached copy of the other side's index,
+ * so the shared line is only re-read when the ring looks full / empty. All hand-offs are
+ * plain acquire / release stores: no CAS, no lock, no allocation after construction.
+ */
+template <typename T>
+class spsc_queue {
+public:
+    explicit spsc_queue(size_t capacity)
+        : mask_(detail::round_up_pow2(capacity < 2 ? 2 : capacity) - 1),
+          slots_(std::make_unique<slot[]>(mask_ + 1)) {}
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    ~spsc_queue() {
+        while (pop_front_nullable()) {
+        }
+    }
+
+    NO_DISCARD size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    NO_DISCARD size_t size() const {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    NO_DISCARD bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Producer only: constructs an element at the back; returns false if the ring is full.
+     */
+    template <class... Args>
+    NO_DISCARD bool try_emplace_back(Args&&... args) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+
+        ::new (slots_[tail & mask_].storage) T(std::forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    NO_DISCARD bool try_push_back(const T& value) {
+        return try_emplace_back(value);
+    }
+
+    NO_DISCARD bool try_push_back(T&& value) {
+        return try_emplace_back(std::move(value));
+    }
+
+    /**
+     * @brief Producer only: pushes, spinning (yielding) while the ring is full.
+     */
+    void push_back(const T& value) {
+        while (!try_emplace_back(value)) {
+            std::this_thread::yield();
+        }
+    }
+
+    void push_back(T&& value) {
+        while (!try_emplace_back(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Producer only: copies up to `count` elements from `first` and publishes them with one store.
+     *
+     * Returns how many elements fit. Pass std::make_move_iterator iterators to move instead of copy.
+     * If constructing an element throws, the elements before it are published and the exception
+     * propagates.
+     */
+    template <std::input_iterator InputIt>
+    size_t try_push_n(InputIt first, size_t count) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t free = capacity() - (tail - cached_head_);
+        if (free < count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            free = capacity() - (tail - cached_head_);
+        }
+
+        count = std::min(count, free);
+        size_t i = 0;
+        try {
+            for (; i < count; ++i, ++first) {
+                ::new (slots_[(tail + i) & mask_].storage) T(*first);
+            }
+        } catch (...) {
+            tail_.store(tail + i, std::memory_order_release);
+            throw;
+        }
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Consumer only: pops the front element, or std::nullopt if the ring is empty.
+     */
+    NO_DISCARD std::optional<T> pop_front_nullable() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return std::nullopt;
+            }
+        }
+
+        T* element = slots_[head & mask_].get();
+        std::optional<T> value(std::move(*element));
+        element->~T();
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    /**
+     * @brief Consumer only: pops, spinning (yielding) while the ring is empty.
+     */
+    NO_DISCARD T pop_front() {
+        for (;;) {
+            if (auto value = pop_front_nullable()) {
+                return std::move(*value);
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Consumer only: moves up to `count` elements into `out` and releases their slots with one store.
+     *
+     * Returns the number of elements popped.
+     */
+    template <class OutputIt>
+    size_t try_pop_n(OutputIt out, size_t count) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+
+        count = std::min(count, cached_tail_ - head);
+        for (size_t i = 0; i < count; ++i, ++out) {
+            T* element = slots_[(head + i) & mask_].get();
+            *out = std::move(*element);
+            element->~T();
+        }
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    struct slot {
+        T* get() {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    const size_t mask_;
+    const std::unique_ptr<slot[]> slots_;
+
+    alignas(detail::cache_line_size) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+
+    alignas(detail::cache_line_size) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+};
+
+/**
+ * @brief Wait-free unbounded single-producer / single-consumer FIFO queue.
+ *
+ * Same contract as ts::spsc_queue, but storage is a linked list of fixed-size chunks:
+ * the producer links a fresh chunk when the current one is full and the consumer
+ * frees each chunk after draining it, so pushes never fail.
+ */
+template <typename T>
+class unbounded_spsc_queue {
+public:
+    unbounded_spsc_queue() : head_(new chunk), tail_(head_) {}
+
+    unbounded_spsc_queue(const unbounded_spsc_queue&) = delete;
+    unbounded_spsc_queue& operator=(const unbounded_spsc_queue&) = delete;
+
+    ~unbounded_spsc_queue() {
+        while (pop_front_nullable()) {
+        }
+        delete head_;
+    }
+
+    NO_DISCARD size_t size() const {
+        size_t popped = popped_.load(std::memory_order_acquire);
+        size_t pushed = pushed_.load(std::memory_order_acquire);
+        return pushed > popped ? pushed - popped : 0;
+    }
+
+    NO_DISCARD bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Producer only: constructs an element at the back.
+     */
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        chunk* target = writable_chunk();
+        size_t index = target->written.load(std::memory_order_relaxed);
+        ::new (target->slot(index)) T(std::forward<Args>(args)...);
+        target->written.store(index + 1, std::memory_order_release);
+        pushed_.store(pushed_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    /**
+     * @brief Producer only: appends `count` elements from `first`, publishing once per chunk.
+     *
+     * Always pushes everything and returns `count`; the name mirrors ts::spsc_queue::try_push_n.
+     * If constructing an element throws, the elements before it are published and the exception
+     * propagates.
+     */
+    template <std::input_iterator InputIt>
+    size_t try_push_n(InputIt first, size_t count) {
+        size_t remaining = count;
+        while (remaining != 0) {
+            chunk* target = writable_chunk();
+            size_t index = target->written.load(std::memory_order_relaxed);
+            size_t batch = std::min(remaining, chunk_capacity - index);
+
+            size_t i = 0;
+            try {
+                for (; i < batch; ++i, ++first) {
+                    ::new (target->slot(index + i)) T(*first);
+                }
+            } catch (...) {
+                target->written.store(index + i, std::memory_order_release);
+                pushed_.store(pushed_.load(std::memory_order_relaxed) + (count - remaining) + i,
+                              std::memory_order_release);
+                throw;
+            }
+            target->written.store(index + batch, std::memory_order_release);
+            remaining -= batch;
+        }
+        pushed_.store(pushed_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Consumer only: pops the front element, or std::nullopt if the queue is empty.
+     */
+    NO_DISCARD std::optional<T> pop_front_nullable() {
+        chunk* source = readable_chunk();
+        if (source == nullptr || source->read == source->written.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+
+        T* element = source->get(source->read);
+        std::optional<T> value(std::move(*element));
+        element->~T();
+        ++source->read;
+        popped_.store(popped_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return value;
+    }
+
+    NO_DISCARD T pop_front() {
+        for (;;) {
+            if (auto value = pop_front_nullable()) {
+                return std::move(*value);
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Consumer only: moves up to `count` elements into `out`. Returns the number popped.
+     */
+    template <class OutputIt>
+    size_t try_pop_n(OutputIt out, size_t count) {
+        size_t popped = 0;
+        while (popped < count) {
+            chunk* source = readable_chunk();
+            if (source == nullptr) {
+                break;
+            }
+
+            size_t available = source->written.load(std::memory_order_acquire) - source->read;
+            size_t batch = std::min(count - popped, available);
+            if (batch == 0) {
+                break;
+            }
+
+            for (size_t i = 0; i < batch; ++i, ++out) {
+                T* element = source->get(source->read + i);
+                *out = std::move(*element);
+                element->~T();
+            }
+            source->read += batch;
+            popped += batch;
+        }
+        popped_.store(popped_.load(std::memory_order_relaxed) + popped, std::memory_order_release);
+        return popped;
+    }
+
+private:
+    static constexpr size_t chunk_capacity = std::max<size_t>(16, 4096 / sizeof(T));
+
+    struct chunk {
+        void* slot(size_t index) {
+            return storage + index * sizeof(T);
+        }
+
+        T* get(size_t index) {
+            return std::launder(reinterpret_cast<T*>(slot(index)));
+        }
+
+        std::atomic<size_t> written{0};
+        size_t read = 0;
+        std::atomic<chunk*> next{nullptr};
+        alignas(T) unsigned char storage[chunk_capacity * sizeof(T)];
+    };
+
+    chunk* writable_chunk() {
+        if (tail_->written.load(std::memory_order_relaxed) == chunk_capacity) {
+            auto* next = new chunk;
+            tail_->next.store(next, std::memory_order_release);
+            tail_ = next;
+        }
+        return tail_;
+    }
+
+    // Moves past a fully drained chunk once the producer has linked its successor.
+    chunk* readable_chunk() {
+        if (head_->read == chunk_capacity) {
+            chunk* next = head_->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                return nullptr;
+            }
+            delete head_;
+            head_ = next;
+        }
+        return head_;
+    }
+
+    alignas(detail::cache_line_size) chunk* head_;
+    std::atomic<size_t> popped_{0};
+
+    alignas(detail::cache_line_size) chunk* tail_;
+    std::atomic<size_t> pushed_{0};
+};
+
+} // namespace ts
+
+#endif // TS_SPSC_QUEUE_H
@@ -0,0 +1,131 @@
+#ifndef TS_TWO_LOCK_QUEUE_H
+#define TS_TWO_LOCK_QUEUE_H
+
+#include "TSCommon.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+
+namespace ts {
+
+/**
+ * @brief FIFO queue with separate head and tail locks (Michael-Scott two-lock queue).
+ *
+ * Producers only take the tail lock and consumers only take the head lock, so
+ * producers contend with other producers and consumers with other consumers, but
+ * the two groups never block each other.
+ *
+ * Elements are stored in a linked list of fixed-size segments rather than one node
+ * per element. A producer publishes a slot by bumping the segment's `written` counter;
+ * the consumer that drains a segment frees it once the producer has linked the next one.
+ */
+template <typename T>
+class two_lock_queue {
+public:
+    two_lock_queue() : head_(new segment), tail_(head_) {}
+
+    two_lock_queue(const two_lock_queue&) = delete;
+    two_lock_queue& operator=(const two_lock_queue&) = delete;
+
+    ~two_lock_queue() {
+        while (pop_front_nullable()) {
+        }
+        delete head_;
+    }
+
+    /**
+     * @brief Number of stored elements; only a hint while other threads are pushing or popping.
+     */
+    NO_DISCARD size_t size() const {
+        size_t popped = popped_.load(std::memory_order_acquire);
+        size_t pushed = pushed_.load(std::memory_order_acquire);
+        return pushed > popped ? pushed - popped : 0;
+    }
+
+    NO_DISCARD bool empty() const {
+        return size() == 0;
+    }
+
+    void push_back(const T& value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template <class... Args>
+    void emplace_back(Args&&... args) {
+        std::lock_guard lock(tail_mutex_);
+        segment* seg = tail_;
+        size_t index = seg->written.load(std::memory_order_relaxed);
+
+        if (index == segment_capacity) {
+            // Owned until linked, so a throwing constructor does not leak the segment.
+            auto next = std::make_unique<segment>();
+            ::new (next->slot(0)) T(std::forward<Args>(args)...);
+            next->written.store(1, std::memory_order_relaxed);
+            seg->next.store(next.get(), std::memory_order_release);
+            tail_ = next.release();
+        } else {
+            ::new (seg->slot(index)) T(std::forward<Args>(args)...);
+            seg->written.store(index + 1, std::memory_order_release);
+        }
+        pushed_.fetch_add(1, std::memory_order_release);
+    }
+
+    NO_DISCARD std::optional<T> pop_front_nullable() {
+        std::lock_guard lock(head_mutex_);
+        segment* seg = head_;
+
+        if (seg->read == segment_capacity) {
+            segment* next = seg->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                return std::nullopt;
+            }
+            delete seg;
+            head_ = seg = next;
+        }
+
+        if (seg->read == seg->written.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+
+        T* element = std::launder(reinterpret_cast<T*>(seg->slot(seg->read)));
+        std::optional<T> value(std::move(*element));
+        element->~T();
+        ++seg->read;
+        popped_.fetch_add(1, std::memory_order_release);
+        return value;
+    }
+
+private:
+    static constexpr size_t segment_capacity = std::max<size_t>(8, 4096 / sizeof(T));
+
+    struct segment {
+        void* slot(size_t index) {
+            return storage + index * sizeof(T);
+        }
+
+        std::atomic<size_t> written{0};
+        size_t read = 0;
+        std::atomic<segment*> next{nullptr};
+        alignas(T) unsigned char storage[segment_capacity * sizeof(T)];
+    };
+
+    alignas(detail::cache_line_size) std::mutex head_mutex_;
+    segment* head_;
+    std::atomic<size_t> popped_{0};
+
+    alignas(detail::cache_line_size) std::mutex tail_mutex_;
+    segment* tail_;
+    std::atomic<size_t> pushed_{0};
+};
+
+} // namespace ts
+
+#endif // TS_TWO_LOCK_QUEUE_H
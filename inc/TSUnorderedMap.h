@@ -0,0 +1,332 @@
+#ifndef TS_UNORDERED_MAP_H
+#define TS_UNORDERED_MAP_H
+
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <optional>
+#include <initializer_list>
+#include <functional>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "TSCommon.h"
+#include "TSLock.h"
+
+namespace ts {
+
+/**
+ * @brief Hash map split into independently locked stripes.
+ *
+ * Every key belongs to one stripe, chosen from the high bits of its (mixed) hash. A stripe
+ * is a std::unordered_map with its own lock, padded to its own cache lines, so operations
+ * on different stripes never contend, and with many more stripes than cores most
+ * operations on different keys do not either. Each stripe rehashes on its own under its
+ * own lock: growing never stops the whole table.
+ *
+ * `LockPolicy` is the per-stripe lock (see TSLock.h). With std::shared_mutex, find(),
+ * contains() and the other const operations on one stripe run concurrently.
+ *
+ * Single-key operations are atomic. Whole-table operations come in two flavours:
+ * for_each(), erase_if() and size() visit the stripes one after another (concurrent writes
+ * to other stripes may or may not be seen), while snapshot() and process() lock every
+ * stripe at once for a consistent view.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>,
+          typename Allocator = std::allocator<std::pair<const K, V>>, typename LockPolicy = std::mutex>
+class unordered_map {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+    using lock_type = LockPolicy;
+    using map_type = std::unordered_map<K, V, Hash, KeyEqual, Allocator>;
+
+    /**
+     * @brief Creates a map with `stripe_count` stripes, rounded up to a power of two.
+     *
+     * The default, four stripes per hardware thread (at least 16), keeps the chance that two
+     * threads hit the same stripe low.
+     */
+    explicit unordered_map(size_t stripe_count = default_stripe_count(), const Hash& hash = Hash(),
+                           const KeyEqual& equal = KeyEqual(), const Allocator& alloc = Allocator())
+        : stripe_count_(detail::round_up_pow2(std::max<size_t>(stripe_count, 1))),
+          stripe_shift_(64 - static_cast<unsigned>(std::countr_zero(stripe_count_))),
+          hash_(hash), stripes_(std::make_unique<stripe[]>(stripe_count_)) {
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            stripes_[i].map = map_type(0, hash, equal, alloc);
+        }
+    }
+
+    /**
+     * @brief Like std::unordered_map, the first of several entries with the same key wins.
+     */
+    unordered_map(std::initializer_list<value_type> init) : unordered_map() {
+        for (const value_type& entry : init) {
+            try_emplace(entry.first, entry.second);
+        }
+    }
+
+    unordered_map(const unordered_map&) = delete;
+    unordered_map& operator=(const unordered_map&) = delete;
+
+    ~unordered_map() = default;
+
+    NO_DISCARD size_t stripe_count() const noexcept {
+        return stripe_count_;
+    }
+
+    /**
+     * @brief Returns a copy of the value stored under `key`, or std::nullopt.
+     */
+    NO_DISCARD std::optional<V> find(const K& key) const {
+        const stripe& s = stripe_for(key);
+        detail::shared_guard<LockPolicy> lock(s.mutex);
+        auto it = s.map.find(key);
+        if (it == s.map.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    NO_DISCARD bool contains(const K& key) const {
+        const stripe& s = stripe_for(key);
+        detail::shared_guard<LockPolicy> lock(s.mutex);
+        return s.map.find(key) != s.map.end();
+    }
+
+    /**
+     * @brief Calls `callback(const V&)` with the value under `key` while its stripe is locked.
+     *
+     * Avoids copying large values out. Returns false, without calling `callback`, if the key is absent.
+     *
+     * ⚠️ Do not store references to the value after this call — they might become invalid when the lock is released.
+     */
+    template <typename F>
+    bool visit(const K& key, F&& callback) const {
+        const stripe& s = stripe_for(key);
+        detail::shared_guard<LockPolicy> lock(s.mutex);
+        auto it = s.map.find(key);
+        if (it == s.map.end()) {
+            return false;
+        }
+        std::forward<F>(callback)(std::as_const(it->second));
+        return true;
+    }
+
+    /**
+     * @brief Inserts or overwrites the value under `key`. Returns true if the key was new.
+     */
+    template <typename M>
+    bool insert_or_assign(const K& key, M&& value) {
+        stripe& s = stripe_for(key);
+        std::lock_guard lock(s.mutex);
+        return s.map.insert_or_assign(key, std::forward<M>(value)).second;
+    }
+
+    template <typename M>
+    bool insert_or_assign(K&& key, M&& value) {
+        stripe& s = stripe_for(key);
+        std::lock_guard lock(s.mutex);
+        return s.map.insert_or_assign(std::move(key), std::forward<M>(value)).second;
+    }
+
+    /**
+     * @brief Constructs a value from `args` if `key` is absent. Returns true if it inserted.
+     *
+     * Like std::unordered_map::try_emplace, `args` are left untouched if the key already exists.
+     */
+    template <typename... Args>
+    bool try_emplace(const K& key, Args&&... args) {
+        stripe& s = stripe_for(key);
+        std::lock_guard lock(s.mutex);
+        return s.map.try_emplace(key, std::forward<Args>(args)...).second;
+    }
+
+    template <typename... Args>
+    bool try_emplace(K&& key, Args&&... args) {
+        stripe& s = stripe_for(key);
+        std::lock_guard lock(s.mutex);
+        return s.map.try_emplace(std::move(key), std::forward<Args>(args)...).second;
+    }
+
+    /**
+     * @brief Atomically modifies the value under `key` with `callback(V&)`.
+     *
+     * Returns false, without calling `callback`, if the key is absent. The stripe stays locked
+     * for the duration of the callback, so keep it short.
+     */
+    template <typename F>
+    bool update(const K& key, F&& callback) {
+        stripe& s = stripe_for(key);
+        std::lock_guard lock(s.mutex);
+        auto it = s.map.find(key);
+        if (it == s.map.end()) {
+            return false;
+        }
+        std::forward<F>(callback)(it->second);
+        return true;
+    }
+
+    /**
+     * @brief Removes `key`. Returns the number of elements removed (0 or 1).
+     */
+    size_t erase(const K& key) {
+        stripe& s = stripe_for(key);
+        std::lock_guard lock(s.mutex);
+        return s.map.erase(key);
+    }
+
+    /**
+     * @brief Removes every element for which `pred(const value_type&)` returns true, one stripe at a time.
+     *
+     * Returns the number of elements removed.
+     */
+    template <typename Pred>
+    size_t erase_if(Pred pred) {
+        size_t removed = 0;
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            std::lock_guard lock(stripes_[i].mutex);
+            removed += std::erase_if(stripes_[i].map, [&](const value_type& entry) { return pred(entry); });
+        }
+        return removed;
+    }
+
+    /**
+     * @brief Calls `callback(const value_type&)` for every element, locking one stripe at a time.
+     *
+     * ⚠️ Do not store references after this call — they might become invalid when the lock is released.
+     */
+    template <typename F>
+    void for_each(F&& callback) const {
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            detail::shared_guard<LockPolicy> lock(stripes_[i].mutex);
+            for (const value_type& entry : stripes_[i].map) {
+                callback(entry);
+            }
+        }
+    }
+
+    /**
+     * @brief Calls `callback(value_type&)` for every element with the whole table locked.
+     *
+     * All other operations block until the callback has visited every element.
+     *
+     * ⚠️ Do not store references after this call — they might become invalid when the lock is released.
+     */
+    template <typename F>
+    void process(F&& callback) {
+        std::vector<std::unique_lock<LockPolicy>> locks = lock_all<std::unique_lock<LockPolicy>>();
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            for (value_type& entry : stripes_[i].map) {
+                callback(entry);
+            }
+        }
+    }
+
+    /**
+     * @brief Consistent copy of the whole table, taken with every stripe locked.
+     */
+    NO_DISCARD map_type snapshot() const {
+        auto locks = lock_all<detail::shared_guard<LockPolicy>>();
+        map_type result(0, hash_, stripes_[0].map.key_eq(), stripes_[0].map.get_allocator());
+        size_t total = 0;
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            total += stripes_[i].map.size();
+        }
+        result.reserve(total);
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            result.insert(stripes_[i].map.begin(), stripes_[i].map.end());
+        }
+        return result;
+    }
+
+    /**
+     * @brief Number of elements, summed stripe by stripe.
+     */
+    NO_DISCARD size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            total += detail::with_shared_lock(stripes_[i].mutex, [&] { return stripes_[i].map.size(); });
+        }
+        return total;
+    }
+
+    NO_DISCARD bool empty() const {
+        return size() == 0;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            std::lock_guard lock(stripes_[i].mutex);
+            stripes_[i].map.clear();
+        }
+    }
+
+    /**
+     * @brief Sizes every stripe for an even share of `count` elements.
+     */
+    void reserve(size_t count) {
+        size_t per_stripe = count / stripe_count_ + 1;
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            std::lock_guard lock(stripes_[i].mutex);
+            stripes_[i].map.reserve(per_stripe);
+        }
+    }
+
+private:
+    struct alignas(detail::cache_line_size) stripe {
+        mutable LockPolicy mutex;
+        map_type map;
+    };
+
+    static size_t default_stripe_count() {
+        return std::max<size_t>(16, size_t{4} * std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // The stripe maps bucket by the low bits of the hash, so stripes use the high bits of a
+    // mixed hash; weak hashes such as std::hash<int> (the identity) still spread evenly.
+    size_t stripe_index(const K& key) const {
+        if (stripe_count_ == 1) {
+            return 0;
+        }
+        auto mixed = static_cast<std::uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(mixed >> stripe_shift_);
+    }
+
+    stripe& stripe_for(const K& key) {
+        return stripes_[stripe_index(key)];
+    }
+
+    const stripe& stripe_for(const K& key) const {
+        return stripes_[stripe_index(key)];
+    }
+
+    // Always in stripe order, so two whole-table operations cannot deadlock.
+    template <typename Guard>
+    std::vector<Guard> lock_all() const {
+        std::vector<Guard> locks;
+        locks.reserve(stripe_count_);
+        for (size_t i = 0; i < stripe_count_; ++i) {
+            locks.emplace_back(stripes_[i].mutex);
+        }
+        return locks;
+    }
+
+    size_t stripe_count_;
+    unsigned stripe_shift_;
+    Hash hash_;
+    std::unique_ptr<stripe[]> stripes_;
+};
+
+} // namespace ts
+
+#endif // TS_UNORDERED_MAP_H
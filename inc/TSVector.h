@@ -2,16 +2,76 @@
 #define TS_VECTOR_H
 
 #include <vector>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <initializer_list>
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <utility>
+
+#include "TSCommon.h"
+#include "TSFilter.h"
+#include "TSLock.h"
+#include "TSLockStats.h"
+#include "TSParallel.h"
 
 namespace ts {
-template <typename T> class vector {
+/**
+ * @brief Mutex-protected std::vector.
+ *
+ * `LockPolicy` is the mutex type guarding the vector (see TSLock.h for the shipped policies).
+ * The default is std::mutex. With std::shared_mutex, const operations (size, empty, snapshot,
+ * read, ...) run concurrently with each other, which suits read-mostly use sites.
+ *
+ * With ts::flat_combining_mutex, the short element operations (push_back, emplace_back,
+ * pop_back, size, empty, clear) are combined: under contention one thread runs a whole
+ * batch of them while the others wait for their results. Operations taking user
+ * callbacks always run on the calling thread.
+ *
+ * Appends are tracked by a cursor, so consumers that poll for new elements can call
+ * snapshot_since() and copy only the tail; every other kind of mutation invalidates
+ * outstanding cursors.
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename LockPolicy = std::mutex> class vector {
+    // LockPolicy itself, or LockPolicy with contention counters under TS_ENABLE_LOCK_STATS.
+    using mutex_type = detail::instrumented_lock_t<LockPolicy>;
+
 public:
+    using vector_type = std::vector<T, Allocator>;
+    using allocator_type = Allocator;
+    using lock_type = LockPolicy;
+
+    /**
+     * @brief Position in the append history, as returned by snapshot_since().
+     *
+     * A default-constructed cursor points at the beginning.
+     */
+    struct cursor {
+        std::uint64_t generation = 0;
+        size_t position = 0;
+    };
+
+    struct delta {
+        // Elements appended since the cursor, or everything if the cursor was invalidated.
+        vector_type elements;
+        // Pass this to the next snapshot_since() call.
+        cursor next;
+        // True if something other than an append happened since the cursor was taken:
+        // `elements` is then the whole vector and replaces what the caller had.
+        bool invalidated = false;
+    };
+
     vector() = default;
 
+    explicit vector(const Allocator& alloc) : data_(alloc) {}
+
     vector(const vector& other) {
+        TS_LOCK_SITE();
         std::unique_lock lock1(mutex_, std::defer_lock);
         std::unique_lock lock2(other.mutex_, std::defer_lock);
         std::lock(lock1, lock2);
@@ -19,143 +79,341 @@ public:
     }
 
     vector(vector&& other) noexcept {
+        TS_LOCK_SITE();
         std::unique_lock lock1(mutex_, std::defer_lock);
         std::unique_lock lock2(other.mutex_, std::defer_lock);
         std::lock(lock1, lock2);
         data_ = std::move(other.data_);
+        other.invalidate_cursors();
     }
 
-    explicit vector(const std::vector<T>& vec) {
+    explicit vector(const vector_type& vec) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
         data_ = vec;
     }
 
-    explicit vector(std::vector<T>&& vec) {
+    explicit vector(vector_type&& vec) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
         data_ = std::move(vec);
     }
 
     vector(std::initializer_list<T> init_list) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
         data_ = init_list;
     }
 
     vector& operator=(const vector& other) {
+        TS_LOCK_SITE();
         if (this != &other) {
             std::unique_lock lock1(mutex_, std::defer_lock);
             std::unique_lock lock2(other.mutex_, std::defer_lock);
             std::lock(lock1, lock2);
             data_ = other.data_;
+            invalidate_cursors();
         }
         return *this;
     }
 
     vector& operator=(vector&& other) noexcept {
+        TS_LOCK_SITE();
         if (this != &other) {
             std::unique_lock lock1(mutex_, std::defer_lock);
             std::unique_lock lock2(other.mutex_, std::defer_lock);
             std::lock(lock1, lock2);
             data_ = std::move(other.data_);
+            invalidate_cursors();
+            other.invalidate_cursors();
         }
         return *this;
     }
 
-    vector& operator=(const std::vector<T>& other) {
+    vector& operator=(const vector_type& other) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
         data_ = other;
+        invalidate_cursors();
         return *this;
     }
 
-    vector& operator=(std::vector<T>&& other) {
+    vector& operator=(vector_type&& other) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
         data_ = std::move(other);
+        invalidate_cursors();
         return *this;
     }
 
     ~vector() = default;
 
     void clear() {
-        std::lock_guard lock(mutex_);
-        data_.clear();
+        TS_LOCK_SITE();
+        detail::with_lock(mutex_, [&] {
+            data_.clear();
+            invalidate_cursors();
+        });
     }
 
     void push_back(const T& value) {
-        std::lock_guard lock(mutex_);
-        data_.push_back(value);
+        TS_LOCK_SITE();
+        detail::with_lock(mutex_, [&] { data_.push_back(value); });
     }
 
     void push_back(T&& value) {
-        std::lock_guard lock(mutex_);
-        data_.push_back(std::move(value));
+        TS_LOCK_SITE();
+        detail::with_lock(mutex_, [&] { data_.push_back(std::move(value)); });
     }
 
     template <class... Args>
     T& emplace_back(Args&&... args) {
+        TS_LOCK_SITE();
+        return detail::with_lock(mutex_, [&]() -> T& { return data_.emplace_back(std::forward<Args>(args)...); });
+    }
+
+    /**
+     * @brief Appends [first, last) under a single lock acquisition.
+     *
+     * Forward ranges are measured first so the buffer grows at most once.
+     * Pass std::make_move_iterator iterators to move the elements instead of copying them.
+     */
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    void push_back_range(InputIt first, Sentinel last) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
-        return data_.emplace_back(std::forward<Args>(args)...);
+        if constexpr (std::forward_iterator<InputIt>) {
+            reserve_for_append(static_cast<size_t>(std::ranges::distance(first, last)));
+        }
+        for (; first != last; ++first) {
+            data_.emplace_back(*first);
+        }
     }
 
-    void pop_back() {
+    /**
+     * @brief Appends every element of `range` under a single lock acquisition.
+     *
+     * Elements of an rvalue container are moved; lvalues and views are copied.
+     */
+    template <std::ranges::input_range R>
+    void append_range(R&& range) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
-        data_.pop_back();
+        if constexpr (std::ranges::sized_range<R>) {
+            reserve_for_append(static_cast<size_t>(std::ranges::size(range)));
+        }
+        for (auto&& element : range) {
+            if constexpr (detail::owns_movable_elements_v<R&&>) {
+                data_.emplace_back(std::move(element));
+            } else {
+                data_.emplace_back(element);
+            }
+        }
+    }
+
+    void pop_back() {
+        TS_LOCK_SITE();
+        detail::with_lock(mutex_, [&] {
+            data_.pop_back();
+            invalidate_cursors();
+        });
     }
 
     void reserve(size_t size) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
         data_.reserve(size);
     }
 
+    // Growing counts as an append; shrinking invalidates cursors.
     void resize(size_t size) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
+        if (size < data_.size()) {
+            invalidate_cursors();
+        }
         data_.resize(size);
     }
 
     void resize(size_t size, const T& value) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
+        if (size < data_.size()) {
+            invalidate_cursors();
+        }
         data_.resize(size, value);
     }
 
     void swap(vector& other) noexcept {
+        TS_LOCK_SITE();
         if (this == &other) return;
         std::scoped_lock lock(mutex_, other.mutex_);
         data_.swap(other.data_);
+        invalidate_cursors();
+        other.invalidate_cursors();
     }
 
-    void swap(std::vector<T>& other) {
+    void swap(vector_type& other) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
         data_.swap(other);
+        invalidate_cursors();
+    }
+
+    allocator_type get_allocator() const {
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] { return data_.get_allocator(); });
     }
 
     bool empty() const {
-        std::lock_guard lock(mutex_);
-        return data_.empty();
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] { return data_.empty(); });
     }
 
     size_t size() const {
-        std::lock_guard lock(mutex_);
-        return data_.size();
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] { return data_.size(); });
     }
 
+    /**
+     * @brief Removes every element for which `pred` returns true.
+     *
+     * Pass a ts::pred object (TSFilter.h) such as `ts::pred::less{10}` to get the SIMD scan on
+     * int, float, uint64_t and other arithmetic element types, which shortens the lock hold time.
+     */
     template <typename Pred>
     void erase_if(Pred pred) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
-        data_.erase(
-            std::remove_if(data_.begin(), data_.end(), pred),
-            data_.end()
-        );
+        erase_and_invalidate(pred);
     }
 
     template <typename Pred>
-    std::vector<T> erase_if_then_snapshot(Pred pred) {
+    vector_type erase_if_then_snapshot(Pred pred) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
-        data_.erase(
-            std::remove_if(data_.begin(), data_.end(), pred),
-            data_.end()
-        );
+        erase_and_invalidate(pred);
 
         return data_;
     }
 
+    /**
+     * @brief erase_if_then_snapshot() into a reused buffer.
+     *
+     * `out` is grown to the current size before the lock is taken; the erase can only shrink
+     * the vector, so the copy allocates under the lock only if other threads appended meanwhile.
+     */
+    template <typename Pred, typename OutAllocator>
+    void erase_if_then_snapshot_into(Pred pred, std::vector<T, OutAllocator>& out) {
+        TS_LOCK_SITE();
+        size_t expected = size();
+        if (out.capacity() < expected) {
+            out.clear();
+            out.reserve(expected);
+        }
+
+        std::lock_guard lock(mutex_);
+        erase_and_invalidate(pred);
+        out.assign(data_.begin(), data_.end());
+    }
+
+    /**
+     * @brief Parallel erase_if for large vectors (see parallel_policy).
+     *
+     * Each thread compacts its own chunk with remove_if, then the survivors are moved
+     * together, so the relative order of the remaining elements is preserved exactly as with
+     * the sequential overload. `pred` is called concurrently and must be thread-safe.
+     */
+    template <typename Pred>
+    void erase_if(const parallel_policy& policy, Pred pred) {
+        TS_LOCK_SITE();
+        std::lock_guard lock(mutex_);
+        unsigned width = detail::parallel_width(policy, data_.size());
+        if (width == 1) {
+            erase_and_invalidate(pred);
+            return;
+        }
+
+        detail::chunking chunks(data_.size(), width);
+        std::vector<size_t> kept(chunks.count);
+        detail::thread_pool::instance().parallel_for(chunks.count, width, [&](size_t chunk) {
+            auto first = data_.begin() + static_cast<std::ptrdiff_t>(chunks.begin(chunk));
+            auto last = data_.begin() + static_cast<std::ptrdiff_t>(chunks.end(chunk));
+            kept[chunk] = static_cast<size_t>(detail::filter_remove_if(first, last, pred) - first);
+        });
+
+        auto out = data_.begin() + static_cast<std::ptrdiff_t>(kept[0]);
+        for (size_t chunk = 1; chunk < chunks.count; ++chunk) {
+            auto first = data_.begin() + static_cast<std::ptrdiff_t>(chunks.begin(chunk));
+            out = std::move(first, first + static_cast<std::ptrdiff_t>(kept[chunk]), out);
+        }
+        if (out != data_.end()) {
+            data_.erase(out, data_.end());
+            invalidate_cursors();
+        }
+    }
+
+    /**
+     * @brief Calls `callback(element)` for every element under an exclusive lock, in parallel
+     * for large vectors (see parallel_policy).
+     *
+     * Elements are visited in no particular order; the callback may modify them and must be
+     * thread-safe.
+     */
+    template <typename F>
+    void for_each(const parallel_policy& policy, F callback) {
+        TS_LOCK_SITE();
+        std::lock_guard lock(mutex_);
+        invalidate_cursors();
+        for_each_chunk(policy, [&](auto first, auto last) { std::for_each(first, last, std::ref(callback)); });
+    }
+
+    /**
+     * @brief Replaces every element with `op(element)`, in parallel for large vectors (see parallel_policy).
+     */
+    template <typename F>
+    void transform(const parallel_policy& policy, F op) {
+        TS_LOCK_SITE();
+        std::lock_guard lock(mutex_);
+        invalidate_cursors();
+        for_each_chunk(policy, [&](auto first, auto last) { std::transform(first, last, first, std::ref(op)); });
+    }
+
+    /**
+     * @brief Sorts the vector, in parallel for large vectors (see parallel_policy).
+     *
+     * Chunks are sorted concurrently and then merged pairwise; like std::sort the result is not stable.
+     */
+    template <typename Compare = std::less<>>
+    void sort(const parallel_policy& policy, Compare comp = Compare{}) {
+        TS_LOCK_SITE();
+        std::lock_guard lock(mutex_);
+        invalidate_cursors();
+        unsigned width = detail::parallel_width(policy, data_.size());
+        if (width == 1) {
+            std::sort(data_.begin(), data_.end(), comp);
+            return;
+        }
+
+        detail::chunking chunks(data_.size(), width);
+        auto at = [&](size_t chunk) {
+            return data_.begin() + static_cast<std::ptrdiff_t>(chunk < chunks.count ? chunks.begin(chunk) : data_.size());
+        };
+        detail::thread_pool& pool = detail::thread_pool::instance();
+        pool.parallel_for(chunks.count, width, [&](size_t chunk) { std::sort(at(chunk), at(chunk + 1), comp); });
+
+        // Each round merges neighbouring sorted runs of `run` chunks.
+        for (size_t run = 1; run < chunks.count; run *= 2) {
+            size_t merges = (chunks.count + 2 * run - 1) / (2 * run);
+            pool.parallel_for(merges, width, [&](size_t merge) {
+                size_t first = merge * 2 * run;
+                size_t middle = std::min(first + run, chunks.count);
+                size_t last = std::min(first + 2 * run, chunks.count);
+                std::inplace_merge(at(first), at(middle), at(last), comp);
+            });
+        }
+    }
+
     /**
      * @brief Executes a user-provided function on the internal vector under a mutex lock.
      *
@@ -166,7 +424,10 @@ public:
      */
     template <typename F>
     void process(F&& callback) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
+        // The callback may change anything, so cursors cannot stay valid.
+        invalidate_cursors();
         std::forward<F>(callback)(data_);
     }
 
@@ -178,19 +439,153 @@ public:
      *
      * ⚠️ Do not store references or iterators after this call — they might become invalid when the lock is released.
     */
-    void process(const std::function<void(std::vector<T>&)>& callback) {
+    void process(const std::function<void(vector_type&)>& callback) {
+        TS_LOCK_SITE();
         std::lock_guard lock(mutex_);
+        invalidate_cursors();
         callback(data_);
     }
 
-    std::vector<T> snapshot() const {
-        std::lock_guard lock(mutex_);
-        return data_;
+    /**
+     * @brief Executes a user-provided function on a const view of the internal vector.
+     *
+     * Read-only counterpart of process(): with a shared lock type, any number of read()
+     * callbacks (and other const operations) run at the same time, while writers wait.
+     * Returns whatever the callback returns.
+     *
+     * ⚠️ Do not store references or iterators after this call — they might become invalid when the lock is released.
+     */
+    template <typename F>
+    decltype(auto) read(F&& callback) const {
+        TS_LOCK_SITE();
+        detail::shared_guard<mutex_type> lock(mutex_);
+        return std::forward<F>(callback)(std::as_const(data_));
+    }
+
+    vector_type snapshot() const {
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] { return data_; });
+    }
+
+    /**
+     * @brief Copies the contents into `out`, reusing its capacity.
+     *
+     * If `out` is too small it is grown with the lock released and the copy is retried, so
+     * the lock is never held across an allocation of the buffer. Once `out` has reached the
+     * working size, repeated calls allocate nothing (see also ts::snapshot_pool).
+     */
+    template <typename OutAllocator>
+    void snapshot_into(std::vector<T, OutAllocator>& out) const {
+        TS_LOCK_SITE();
+        detail::copy_into_reused(out, [&] {
+            return detail::with_shared_lock(mutex_, [&]() -> size_t {
+                if (data_.size() > out.capacity()) {
+                    return data_.size();
+                }
+                out.assign(data_.begin(), data_.end());
+                return 0;
+            });
+        });
+    }
+
+    /**
+     * @brief Copies up to `out.size()` elements into a fixed buffer and returns the vector's size.
+     *
+     * A result larger than `out.size()` means the copy was truncated (like snprintf).
+     */
+    size_t snapshot_into(std::span<T> out) const {
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] {
+            std::copy_n(data_.begin(), std::min(out.size(), data_.size()), out.begin());
+            return data_.size();
+        });
+    }
+
+    /**
+     * @brief Copies only the elements appended since `from`, in O(appended) under the lock.
+     *
+     * Typical polling loop:
+     *
+     *     auto d = vec.snapshot_since(c);
+     *     if (d.invalidated) view.clear();
+     *     view.insert(view.end(), d.elements.begin(), d.elements.end());
+     *     c = d.next;
+     *
+     * Appends (push_back, emplace_back, push_back_range, append_range, growing resize) keep
+     * cursors valid. Anything else (erase_if, clear, pop_back, process, swap, assignment,
+     * shrinking resize) invalidates them, and the next call returns the full contents with
+     * `invalidated` set. Writes through references returned by emplace_back are not tracked.
+     */
+    delta snapshot_since(const cursor& from) const {
+        TS_LOCK_SITE();
+        return detail::with_shared_lock(mutex_, [&] {
+            delta result;
+            bool valid = from.generation == generation_ && from.position <= data_.size();
+            auto first = data_.begin() + static_cast<std::ptrdiff_t>(valid ? from.position : 0);
+
+            result.elements.assign(first, data_.end());
+            result.next = cursor{generation_, data_.size()};
+            result.invalidated = !valid;
+            return result;
+        });
+    }
+
+    /**
+     * @brief Contention and hold-time counters of this vector's lock (see TSLockStats.h).
+     *
+     * All zero unless the program is built with TS_ENABLE_LOCK_STATS.
+     */
+    NO_DISCARD lock_stats stats() const {
+        return detail::lock_stats_of(mutex_);
+    }
+
+    /**
+     * @brief Names this vector in lock_registry dumps. No-op without TS_ENABLE_LOCK_STATS.
+     */
+    void set_stats_label(std::string label) {
+        detail::set_lock_stats_label(mutex_, std::move(label));
     }
 
 private:
-    mutable std::mutex mutex_;
-    std::vector<T> data_;
+    void invalidate_cursors() {
+        ++generation_;
+    }
+
+    template <typename Pred>
+    void erase_and_invalidate(Pred& pred) {
+        auto removed = detail::filter_remove_if(data_.begin(), data_.end(), pred);
+        if (removed != data_.end()) {
+            data_.erase(removed, data_.end());
+            invalidate_cursors();
+        }
+    }
+
+    // Calls `body(first, last)` for contiguous chunks covering the vector. Must hold mutex_.
+    template <typename Body>
+    void for_each_chunk(const parallel_policy& policy, Body body) {
+        unsigned width = detail::parallel_width(policy, data_.size());
+        if (width == 1) {
+            body(data_.begin(), data_.end());
+            return;
+        }
+        detail::chunking chunks(data_.size(), width);
+        detail::thread_pool::instance().parallel_for(chunks.count, width, [&](size_t chunk) {
+            body(data_.begin() + static_cast<std::ptrdiff_t>(chunks.begin(chunk)),
+                 data_.begin() + static_cast<std::ptrdiff_t>(chunks.end(chunk)));
+        });
+    }
+
+    // Keeps geometric growth so repeated small appends stay amortized O(1).
+    void reserve_for_append(size_t count) {
+        size_t required = data_.size() + count;
+        if (required > data_.capacity()) {
+            data_.reserve(std::max(required, data_.capacity() * 2));
+        }
+    }
+
+    mutable mutex_type mutex_;
+    std::uint64_t generation_ = 0;
+    vector_type data_;
 };
 
 } // namespace ts
@@ -0,0 +1,159 @@
+#ifndef TS_WORK_STEALING_DEQUE_H
+#define TS_WORK_STEALING_DEQUE_H
+
+#include "TSCommon.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+
+namespace ts {
+
+/**
+ * @brief Chase-Lev work-stealing deque.
+ *
+ * One owner thread calls push_back / pop_back_nullable at the bottom without taking any lock;
+ * any number of thief threads call steal() to take from the top with a single CAS.
+ * Only the owner and a thief racing for the very last element ever contend.
+ *
+ * Elements are stored in a circular array that the owner doubles when it fills up.
+ * Superseded arrays are kept until the deque is destroyed, because a thief may still be
+ * reading from one. Elements must be trivially copyable (typically task pointers or indices).
+ */
+template <typename T>
+class work_stealing_deque {
+    static_assert(std::is_trivially_copyable_v<T>, "ts::work_stealing_deque requires a trivially copyable T");
+
+public:
+    explicit work_stealing_deque(size_t initial_capacity = 64) {
+        auto initial = std::make_unique<ring>(detail::round_up_pow2(initial_capacity < 2 ? 2 : initial_capacity));
+        array_.store(initial.get(), std::memory_order_relaxed);
+        arrays_.push_back(std::move(initial));
+    }
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+    ~work_stealing_deque() = default;
+
+    /**
+     * @brief Number of stored elements; only a hint while thieves are active.
+     */
+    NO_DISCARD size_t size() const {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+    NO_DISCARD bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Owner only: pushes an element at the bottom, growing the array if it is full.
+     */
+    void push_back(T value) {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        ring* array = array_.load(std::memory_order_relaxed);
+
+        if (bottom - top > static_cast<std::int64_t>(array->capacity) - 1) {
+            array = grow(array, top, bottom);
+        }
+
+        array->put(bottom, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Owner only: pops the most recently pushed element (LIFO).
+     */
+    NO_DISCARD std::optional<T> pop_back_nullable() {
+        std::int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        ring* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T value = array->get(bottom);
+        if (top == bottom) {
+            // Last element: race the thieves for it.
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                return std::nullopt;
+            }
+        }
+        return value;
+    }
+
+    /**
+     * @brief Any thread: takes the oldest element (FIFO).
+     *
+     * Returns std::nullopt when the deque is empty or another thread won the race for the top element.
+     */
+    NO_DISCARD std::optional<T> steal() {
+        std::int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t bottom = bottom_.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return std::nullopt;
+        }
+
+        ring* array = array_.load(std::memory_order_acquire);
+        T value = array->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+private:
+    struct ring {
+        explicit ring(size_t capacity)
+            : capacity(capacity), mask(capacity - 1), slots(std::make_unique<std::atomic<T>[]>(capacity)) {}
+
+        T get(std::int64_t index) const {
+            return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t index, T value) {
+            slots[static_cast<size_t>(index) & mask].store(value, std::memory_order_relaxed);
+        }
+
+        const size_t capacity;
+        const size_t mask;
+        const std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    ring* grow(ring* old, std::int64_t top, std::int64_t bottom) {
+        auto bigger = std::make_unique<ring>(old->capacity * 2);
+        for (std::int64_t i = top; i < bottom; ++i) {
+            bigger->put(i, old->get(i));
+        }
+
+        ring* result = bigger.get();
+        arrays_.push_back(std::move(bigger));
+        array_.store(result, std::memory_order_release);
+        return result;
+    }
+
+    alignas(detail::cache_line_size) std::atomic<std::int64_t> top_{0};
+    alignas(detail::cache_line_size) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<ring*> array_{nullptr};
+    std::vector<std::unique_ptr<ring>> arrays_;
+};
+
+} // namespace ts
+
+#endif // TS_WORK_STEALING_DEQUE_H
@@ -1,9 +1,42 @@
 #include <gtest/gtest.h>
 #include <TSVector.h>
 #include <TSDeque.h>
+#include <TSBoundedQueue.h>
+#include <TSWorkStealingDeque.h>
+#include <TSTwoLockQueue.h>
+#include <TSSpscQueue.h>
+#include <TSPoolAllocator.h>
+#include <TSShardedDeque.h>
+#include <TSPriorityQueue.h>
+#include <TSLock.h>
+#include <TSCowVector.h>
+#include <TSReadMostlyVector.h>
+#include <TSConcurrentVector.h>
+#include <TSSnapshotPool.h>
+#include <TSUnorderedMap.h>
+#include <TSOrderedMap.h>
+#include <TSLruCache.h>
+#include <TSObjectPool.h>
+#include <TSLockStats.h>
 #include <thread>
 #include <string>
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <list>
+#include <iterator>
+#include <sstream>
+#include <numeric>
+#include <bit>
+#include <ranges>
+#include <coroutine>
+#include <stdexcept>
+#include <shared_mutex>
+#include <random>
+#include <limits>
+#include <array>
+#include <span>
+#include <set>
 
 // === ts::vector tests ===
 
@@ -179,6 +212,9 @@ TEST(TSVectorTest, ConcurrentEraseAndInsert) {
     eraser.join();
     inserter.join();
 
+    // The eraser may observe `done` before its last pass sees the final inserts.
+    vec.erase_if([](int v) { return v % 10 == 0; });
+
     auto snap = vec.snapshot();
     for (int val : snap) {
         EXPECT_NE(val % 10, 0);
@@ -213,4 +249,2293 @@ TEST(TSDequeTest, HighConcurrencyStress) {
     for (auto& p : producers) p.join();
     consumer.join();
     EXPECT_TRUE(d.empty());
-}
\ No newline at end of file
+}
+
+TEST(TSDequeTest, WaitPopFrontBlocksUntilPush) {
+    ts::deque<int> d;
+    std::atomic<bool> popped = false;
+
+    std::thread consumer([&] {
+        EXPECT_EQ(d.wait_pop_front(), 42);
+        popped = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(popped);
+
+    d.push_back(42);
+    consumer.join();
+    EXPECT_TRUE(popped);
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(TSDequeTest, WaitPopBackTakesNewestElement) {
+    ts::deque<int> d;
+    d.push_back(1);
+    d.push_back(2);
+
+    EXPECT_EQ(d.wait_pop_back(), 2);
+    EXPECT_EQ(d.wait_pop_back(), 1);
+}
+
+TEST(TSDequeTest, TryPopForTimesOutWhenEmpty) {
+    ts::deque<int> d;
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(d.try_pop_for(std::chrono::milliseconds(10)), std::nullopt);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(10));
+
+    d.push_back(7);
+    EXPECT_EQ(d.try_pop_until(std::chrono::steady_clock::now()), 7);
+}
+
+TEST(TSDequeTest, BoundedPushBlocksUntilPop) {
+    ts::deque<int> d;
+    d.set_max_capacity(2);
+    d.push_back(1);
+    d.push_back(2);
+
+    std::atomic<bool> pushed = false;
+    std::thread producer([&] {
+        d.push_back(3);
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(pushed);
+    EXPECT_EQ(d.size(), 2);
+
+    EXPECT_EQ(d.pop_front(), 1);
+    producer.join();
+    EXPECT_TRUE(pushed);
+    EXPECT_EQ(d.pop_front(), 2);
+    EXPECT_EQ(d.pop_front(), 3);
+}
+
+TEST(TSDequeTest, TryPushBackForTimesOutWhenFull) {
+    ts::deque<std::string> d;
+    d.set_max_capacity(1);
+    EXPECT_TRUE(d.try_push_back_for(std::string("a"), std::chrono::milliseconds(1)));
+
+    std::string value = "b";
+    EXPECT_FALSE(d.try_push_back_for(std::move(value), std::chrono::milliseconds(10)));
+    EXPECT_EQ(value, "b");
+    EXPECT_EQ(d.size(), 1);
+
+    d.set_max_capacity(0);
+    EXPECT_TRUE(d.try_push_back_for(std::move(value), std::chrono::milliseconds(1)));
+    EXPECT_EQ(d.size(), 2);
+}
+
+TEST(TSDequeTest, BoundedProducersBlockingConsumers) {
+    ts::deque<int> d;
+    d.set_max_capacity(16);
+
+    constexpr int producers = 4;
+    constexpr int consumers = 4;
+    constexpr int items = 5000;
+
+    std::atomic<long long> sum = 0;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&d] {
+            for (int i = 1; i <= items; ++i) d.push_back(i);
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < producers * items / consumers; ++i) {
+                sum += d.wait_pop_front();
+                EXPECT_LE(d.size(), 16u);
+            }
+        });
+    }
+
+    for (auto& t : threads) t.join();
+    EXPECT_TRUE(d.empty());
+    EXPECT_EQ(sum, static_cast<long long>(producers) * items * (items + 1) / 2);
+}
+
+// === ts::bounded_queue tests ===
+
+TEST(TSBoundedQueueTest, FifoOrderAndCapacity) {
+    ts::bounded_queue<std::string> q(3);
+    EXPECT_EQ(q.capacity(), 4);
+    EXPECT_TRUE(q.empty());
+
+    q.push_back("A");
+    q.emplace_back(2, 'B');
+    EXPECT_EQ(q.size(), 2);
+
+    EXPECT_EQ(q.pop_front(), "A");
+    EXPECT_EQ(q.pop_front_nullable(), "BB");
+    EXPECT_EQ(q.pop_front_nullable(), std::nullopt);
+}
+
+TEST(TSBoundedQueueTest, TryPushFailsWhenFull) {
+    ts::bounded_queue<int> q(2);
+    EXPECT_TRUE(q.try_push_back(1));
+    EXPECT_TRUE(q.try_push_back(2));
+    EXPECT_FALSE(q.try_push_back(3));
+
+    EXPECT_EQ(q.pop_front(), 1);
+    EXPECT_TRUE(q.try_push_back(3));
+    EXPECT_EQ(q.pop_front(), 2);
+    EXPECT_EQ(q.pop_front(), 3);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(TSBoundedQueueTest, DestroysRemainingElements) {
+    auto tracked = std::make_shared<int>(0);
+    {
+        ts::bounded_queue<std::shared_ptr<int>> q(8);
+        q.push_back(tracked);
+        q.push_back(tracked);
+        EXPECT_EQ(tracked.use_count(), 3);
+    }
+    EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST(TSBoundedQueueTest, ThrowingConstructorLeavesRingUsable) {
+    struct Picky {
+        explicit Picky(int v) : value(v) {
+            if (v < 0) throw std::invalid_argument("negative");
+        }
+        Picky(Picky&&) noexcept = default;
+        int value;
+    };
+
+    ts::bounded_queue<Picky> q(2);
+    // Every lap passes the same two slots; a throw inside a claimed slot would block them forever.
+    for (int lap = 0; lap < 4; ++lap) {
+        EXPECT_THROW((void)q.try_emplace_back(-1), std::invalid_argument);
+        EXPECT_TRUE(q.try_emplace_back(lap));
+        EXPECT_EQ(q.size(), 1u);
+        EXPECT_EQ(q.pop_front().value, lap);
+    }
+}
+
+TEST(TSBoundedQueueTest, ConcurrentProducersConsumers) {
+    ts::bounded_queue<int> q(64);
+
+    constexpr int producers = 4;
+    constexpr int consumers = 4;
+    constexpr int items = 10000;
+
+    std::atomic<long long> sum = 0;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&q] {
+            for (int i = 1; i <= items; ++i) q.push_back(i);
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < producers * items / consumers; ++i) sum += q.pop_front();
+        });
+    }
+
+    for (auto& t : threads) t.join();
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(sum, static_cast<long long>(producers) * items * (items + 1) / 2);
+}
+
+// === bulk operations ===
+
+TEST(TSVectorTest, PushBackRangeAndAppendRange) {
+    ts::vector<int> v{1};
+    std::list<int> source{2, 3};
+    v.push_back_range(source.begin(), source.end());
+
+    std::istringstream input("4 5");
+    v.push_back_range(std::istream_iterator<int>(input), std::istream_iterator<int>());
+
+    v.append_range(std::vector<int>{6, 7});
+    v.append_range(source | std::views::transform([](int x) { return x * 10; }));
+
+    EXPECT_EQ(v.snapshot(), (std::vector<int>{1, 2, 3, 4, 5, 6, 7, 20, 30}));
+}
+
+TEST(TSVectorTest, AppendRangeMovesOnlyFromRvalues) {
+    ts::vector<std::string> v;
+    std::vector<std::string> source{"a", "b"};
+
+    v.append_range(source);
+    EXPECT_EQ(source, (std::vector<std::string>{"a", "b"}));
+
+    v.append_range(std::views::all(source));
+    EXPECT_EQ(source, (std::vector<std::string>{"a", "b"}));
+
+    std::vector<std::unique_ptr<int>> owned;
+    owned.push_back(std::make_unique<int>(1));
+    ts::vector<std::unique_ptr<int>> moved;
+    moved.append_range(std::move(owned));
+    EXPECT_EQ(moved.size(), 1);
+    EXPECT_EQ(v.size(), 4);
+}
+
+TEST(TSDequeTest, PushBackRangeAndPopFrontBulk) {
+    ts::deque<int> d;
+    std::vector<int> source{1, 2, 3, 4, 5};
+    d.push_back_range(source.begin(), source.end());
+    d.append_range(std::vector<int>{6, 7});
+
+    std::vector<int> out;
+    EXPECT_EQ(d.pop_front_bulk(3, std::back_inserter(out)), 3);
+    EXPECT_EQ(out, (std::vector<int>{1, 2, 3}));
+
+    EXPECT_EQ(d.pop_front_bulk(10, std::back_inserter(out)), 4);
+    EXPECT_EQ(out, (std::vector<int>{1, 2, 3, 4, 5, 6, 7}));
+    EXPECT_EQ(d.pop_front_bulk(1, std::back_inserter(out)), 0);
+}
+
+TEST(TSDequeTest, DrainIntoAppendsAndEmpties) {
+    ts::deque<std::string> d{"x", "y"};
+    std::vector<std::string> out{"w"};
+
+    EXPECT_EQ(d.drain_into(out), 2);
+    EXPECT_EQ(out, (std::vector<std::string>{"w", "x", "y"}));
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(TSDequeTest, BoundedPushBackRangeWaitsForConsumer) {
+    ts::deque<int> d;
+    d.set_max_capacity(4);
+
+    std::vector<int> source(100);
+    std::iota(source.begin(), source.end(), 0);
+
+    std::thread producer([&] { d.push_back_range(source.begin(), source.end()); });
+
+    std::vector<int> out;
+    while (out.size() < source.size()) {
+        if (auto value = d.try_pop_for(std::chrono::seconds(5))) {
+            out.push_back(*value);
+        } else {
+            break;
+        }
+        EXPECT_LE(d.size(), 4u);
+    }
+
+    producer.join();
+    EXPECT_EQ(out, source);
+}
+
+// === ts::work_stealing_deque tests ===
+
+TEST(TSWorkStealingDequeTest, OwnerLifoThiefFifo) {
+    ts::work_stealing_deque<int> d;
+    d.push_back(1);
+    d.push_back(2);
+    d.push_back(3);
+
+    EXPECT_EQ(d.size(), 3);
+    EXPECT_EQ(d.steal(), 1);
+    EXPECT_EQ(d.pop_back_nullable(), 3);
+    EXPECT_EQ(d.pop_back_nullable(), 2);
+    EXPECT_EQ(d.pop_back_nullable(), std::nullopt);
+    EXPECT_EQ(d.steal(), std::nullopt);
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(TSWorkStealingDequeTest, GrowsPastInitialCapacity) {
+    ts::work_stealing_deque<int> d(2);
+    for (int i = 0; i < 1000; ++i) d.push_back(i);
+    EXPECT_EQ(d.steal(), 0);
+    for (int i = 999; i >= 1; --i) EXPECT_EQ(d.pop_back_nullable(), i);
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(TSWorkStealingDequeTest, EveryElementTakenExactlyOnce) {
+    ts::work_stealing_deque<int> d(4);
+    constexpr int items = 20000;
+    constexpr int thieves = 3;
+
+    std::vector<std::atomic<int>> seen(items);
+    std::atomic<bool> done = false;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thieves; ++t) {
+        threads.emplace_back([&] {
+            while (!done) {
+                if (auto value = d.steal()) {
+                    seen[*value]++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < items; ++i) {
+        d.push_back(i);
+        if (i % 3 == 0) {
+            if (auto value = d.pop_back_nullable()) seen[*value]++;
+        }
+    }
+    while (auto value = d.pop_back_nullable()) seen[*value]++;
+
+    done = true;
+    for (auto& t : threads) t.join();
+
+    for (int i = 0; i < items; ++i) {
+        EXPECT_EQ(seen[i], 1) << "element " << i;
+    }
+}
+
+// === ts::two_lock_queue tests ===
+
+TEST(TSTwoLockQueueTest, FifoAcrossSegments) {
+    ts::two_lock_queue<std::string> q;
+    for (int i = 0; i < 1000; ++i) q.push_back(std::to_string(i));
+    EXPECT_EQ(q.size(), 1000);
+
+    for (int i = 0; i < 1000; ++i) EXPECT_EQ(q.pop_front_nullable(), std::to_string(i));
+    EXPECT_EQ(q.pop_front_nullable(), std::nullopt);
+    EXPECT_TRUE(q.empty());
+
+    q.emplace_back(3, 'z');
+    EXPECT_EQ(q.pop_front_nullable(), "zzz");
+}
+
+TEST(TSTwoLockQueueTest, DestroysRemainingElements) {
+    auto tracked = std::make_shared<int>(0);
+    {
+        ts::two_lock_queue<std::shared_ptr<int>> q;
+        for (int i = 0; i < 1000; ++i) q.push_back(tracked);
+        EXPECT_EQ(tracked.use_count(), 1001);
+    }
+    EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST(TSTwoLockQueueTest, ThrowingConstructorKeepsQueueIntact) {
+    struct Picky {
+        explicit Picky(int v) : value(v) {
+            if (v < 0) throw std::invalid_argument("negative");
+        }
+        int value;
+    };
+
+    ts::two_lock_queue<Picky> q;
+    // A throw after every push also lands on each segment boundary, where a new segment is allocated.
+    for (int i = 0; i < 3000; ++i) {
+        q.emplace_back(i);
+        EXPECT_THROW(q.emplace_back(-1), std::invalid_argument);
+    }
+    EXPECT_EQ(q.size(), 3000);
+    for (int i = 0; i < 3000; ++i) EXPECT_EQ(q.pop_front_nullable()->value, i);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(TSTwoLockQueueTest, ConcurrentProducersConsumersKeepPerProducerOrder) {
+    ts::two_lock_queue<std::pair<int, int>> q;
+
+    constexpr int producers = 4;
+    constexpr int consumers = 3;
+    constexpr int items = 10000;
+
+    std::atomic<int> consumed = 0;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&q, p] {
+            for (int i = 0; i < items; ++i) q.push_back({p, i});
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            std::vector<int> last(producers, -1);
+            while (consumed < producers * items) {
+                if (auto item = q.pop_front_nullable()) {
+                    EXPECT_GT(item->second, last[item->first]);
+                    last[item->first] = item->second;
+                    ++consumed;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (auto& t : threads) t.join();
+    EXPECT_TRUE(q.empty());
+}
+
+// === ts::spsc_queue / ts::unbounded_spsc_queue tests ===
+
+TEST(TSSpscQueueTest, BoundedFifoAndFull) {
+    ts::spsc_queue<std::string> q(2);
+    EXPECT_TRUE(q.try_push_back("a"));
+    EXPECT_TRUE(q.try_emplace_back(2, 'b'));
+    EXPECT_FALSE(q.try_push_back("c"));
+    EXPECT_EQ(q.size(), 2);
+
+    EXPECT_EQ(q.pop_front_nullable(), "a");
+    EXPECT_EQ(q.pop_front(), "bb");
+    EXPECT_EQ(q.pop_front_nullable(), std::nullopt);
+}
+
+TEST(TSSpscQueueTest, BoundedBatchPushPop) {
+    ts::spsc_queue<int> q(8);
+    std::vector<int> input(12);
+    std::iota(input.begin(), input.end(), 0);
+
+    EXPECT_EQ(q.try_push_n(input.begin(), input.size()), 8);
+
+    std::vector<int> out;
+    EXPECT_EQ(q.try_pop_n(std::back_inserter(out), 5), 5);
+    EXPECT_EQ(q.try_push_n(input.begin() + 8, 4), 4);
+    EXPECT_EQ(q.try_pop_n(std::back_inserter(out), 100), 7);
+    EXPECT_EQ(out, input);
+}
+
+// Copying a negative value throws; `tracked` counts live copies.
+struct ThrowingCopy {
+    ThrowingCopy(int v, std::shared_ptr<int> t) : value(v), tracked(std::move(t)) {}
+    ThrowingCopy(const ThrowingCopy& other) : value(other.value), tracked(other.tracked) {
+        if (value < 0) throw std::invalid_argument("negative");
+    }
+    ThrowingCopy(ThrowingCopy&&) noexcept = default;
+    int value;
+    std::shared_ptr<int> tracked;
+};
+
+static std::vector<ThrowingCopy> throwing_batch(size_t size, size_t bad, const std::shared_ptr<int>& tracked) {
+    std::vector<ThrowingCopy> input;
+    for (size_t i = 0; i < size; ++i) input.emplace_back(i == bad ? -1 : static_cast<int>(i), tracked);
+    return input;
+}
+
+TEST(TSSpscQueueTest, ThrowingBatchPushPublishesPrefix) {
+    auto tracked = std::make_shared<int>(0);
+    auto input = throwing_batch(6, 3, tracked);
+    {
+        ts::spsc_queue<ThrowingCopy> q(8);
+        EXPECT_THROW(q.try_push_n(input.begin(), input.size()), std::invalid_argument);
+        EXPECT_EQ(q.size(), 3);
+
+        // The slots after the published prefix are free again, not overwritten live objects.
+        EXPECT_EQ(q.try_push_n(input.begin() + 4, 2), 2);
+        for (int expected : {0, 1, 2, 4, 5}) EXPECT_EQ(q.pop_front().value, expected);
+        EXPECT_EQ(q.try_push_n(input.begin(), 2), 2);
+    }
+    EXPECT_EQ(tracked.use_count(), 1 + static_cast<long>(input.size()));
+
+    {
+        // Throws several chunks in, after earlier chunks were already published.
+        auto long_input = throwing_batch(1000, 600, tracked);
+        ts::unbounded_spsc_queue<ThrowingCopy> q;
+        EXPECT_THROW(q.try_push_n(long_input.begin(), long_input.size()), std::invalid_argument);
+        EXPECT_EQ(q.size(), 600);
+
+        q.push_back(ThrowingCopy(1000, tracked));
+        for (int i = 0; i < 600; ++i) EXPECT_EQ(q.pop_front().value, i);
+        EXPECT_EQ(q.pop_front().value, 1000);
+        EXPECT_TRUE(q.empty());
+    }
+    EXPECT_EQ(tracked.use_count(), 1 + static_cast<long>(input.size()));
+}
+
+TEST(TSSpscQueueTest, UnboundedBatchAcrossChunks) {
+    ts::unbounded_spsc_queue<int> q;
+    std::vector<int> input(5000);
+    std::iota(input.begin(), input.end(), 0);
+
+    EXPECT_EQ(q.try_push_n(input.begin(), input.size()), input.size());
+    q.push_back(5000);
+    EXPECT_EQ(q.size(), 5001);
+
+    std::vector<int> out;
+    EXPECT_EQ(q.try_pop_n(std::back_inserter(out), 4000), 4000);
+    while (auto value = q.pop_front_nullable()) out.push_back(*value);
+
+    input.push_back(5000);
+    EXPECT_EQ(out, input);
+    EXPECT_TRUE(q.empty());
+}
+
+template <typename Queue>
+static void run_spsc_ordering(Queue& q) {
+    constexpr int items = 100000;
+
+    std::thread producer([&q] {
+        for (int i = 0; i < items; i += 4) {
+            int batch[4] = {i, i + 1, i + 2, i + 3};
+            size_t pushed = 0;
+            while (pushed < 4) {
+                pushed += q.try_push_n(batch + pushed, 4 - pushed);
+                if (pushed < 4) std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    std::vector<int> out;
+    while (expected < items) {
+        out.clear();
+        if (q.try_pop_n(std::back_inserter(out), 7) == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (int value : out) EXPECT_EQ(value, expected++);
+    }
+    producer.join();
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(TSSpscQueueTest, BoundedConcurrentOrdering) {
+    ts::spsc_queue<int> q(64);
+    run_spsc_ordering(q);
+}
+
+TEST(TSSpscQueueTest, UnboundedConcurrentOrdering) {
+    ts::unbounded_spsc_queue<int> q;
+    run_spsc_ordering(q);
+}
+
+// === allocator support / ts::pool_allocator tests ===
+
+TEST(TSPoolAllocatorTest, ReusesFreedBlocks) {
+    ts::pool_allocator<int> alloc;
+    int* first = alloc.allocate(10);
+    alloc.deallocate(first, 10);
+
+    int* second = alloc.allocate(12);
+    EXPECT_EQ(first, second);
+
+    int* other = alloc.allocate(12);
+    EXPECT_NE(second, other);
+    alloc.deallocate(second, 12);
+    alloc.deallocate(other, 12);
+
+    ts::pool_allocator<double> rebound(alloc);
+    EXPECT_TRUE(rebound == alloc);
+}
+
+TEST(TSPoolAllocatorTest, LargeAndCrossThreadBlocks) {
+    ts::pool_allocator<char> alloc;
+    char* large = alloc.allocate(1 << 20);
+    large[0] = 'x';
+    large[(1 << 20) - 1] = 'y';
+    alloc.deallocate(large, 1 << 20);
+
+    std::vector<char*> blocks;
+    for (int i = 0; i < 1000; ++i) {
+        blocks.push_back(alloc.allocate(100));
+        blocks.back()[99] = static_cast<char>(i);
+    }
+    std::thread releaser([&] {
+        for (char* block : blocks) alloc.deallocate(block, 100);
+    });
+    releaser.join();
+}
+
+TEST(TSVectorTest, PoolAllocatedVector) {
+    ts::vector<std::string, ts::pool_allocator<std::string>> v;
+    for (int i = 0; i < 1000; ++i) v.push_back(std::to_string(i));
+
+    auto snap = v.snapshot();
+    static_assert(std::is_same_v<decltype(snap), std::vector<std::string, ts::pool_allocator<std::string>>>);
+    ASSERT_EQ(snap.size(), 1000);
+    EXPECT_EQ(snap[999], "999");
+}
+
+TEST(TSDequeTest, PoolAllocatedDequeAcrossThreads) {
+    ts::deque<int, ts::pool_allocator<int>> d;
+    constexpr int items = 20000;
+
+    std::thread producer([&] {
+        for (int i = 0; i < items; ++i) d.push_back(i);
+    });
+
+    long long sum = 0;
+    for (int i = 0; i < items; ++i) sum += d.wait_pop_front();
+    producer.join();
+
+    EXPECT_EQ(sum, static_cast<long long>(items) * (items - 1) / 2);
+    std::vector<int> drained;
+    EXPECT_EQ(d.drain_into(drained), 0);
+}
+
+// === ts::sharded_deque tests ===
+
+TEST(TSShardedDequeTest, SingleThreadIsFifo) {
+    ts::sharded_deque<int> d(4);
+    EXPECT_EQ(d.shard_count(), 4);
+    for (int i = 0; i < 100; ++i) d.push_back(i);
+    EXPECT_EQ(d.size(), 100);
+
+    for (int i = 0; i < 100; ++i) EXPECT_EQ(d.pop_front_nullable(), i);
+    EXPECT_EQ(d.pop_front_nullable(), std::nullopt);
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(TSShardedDequeTest, ConsumersStealFromOtherShards) {
+    ts::sharded_deque<std::string> d(8);
+    std::thread producer([&] {
+        d.push_back("a");
+        d.emplace_back(2, 'b');
+    });
+    producer.join();
+
+    EXPECT_EQ(d.size(), 2);
+    EXPECT_EQ(d.pop_front_nullable(), "a");
+    EXPECT_EQ(d.pop_front_nullable(), "bb");
+
+    d.push_back("c");
+    d.clear();
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(TSShardedDequeTest, PerProducerOrderUnderContention) {
+    ts::sharded_deque<std::pair<int, int>> d(3);
+
+    constexpr int producers = 6;
+    constexpr int items = 5000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&d, p] {
+            for (int i = 0; i < items; ++i) d.push_back({p, i});
+        });
+    }
+
+    std::vector<int> last(producers, -1);
+    int consumed = 0;
+    while (consumed < producers * items) {
+        if (auto item = d.pop_front_nullable()) {
+            EXPECT_GT(item->second, last[item->first]);
+            last[item->first] = item->second;
+            ++consumed;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& t : threads) t.join();
+    EXPECT_TRUE(d.empty());
+}
+
+// === ts::priority_queue tests ===
+
+TEST(TSPriorityQueueTest, SingleHeapPairIsNearlyOrdered) {
+    ts::priority_queue<int> pq(2);
+    for (int i = 0; i < 100; ++i) pq.push(i);
+    EXPECT_EQ(pq.size(), 100);
+
+    // With two heaps, a pop always compares both tops, so it returns the global maximum.
+    for (int i = 99; i >= 0; --i) EXPECT_EQ(pq.try_pop(), i);
+    EXPECT_EQ(pq.try_pop(), std::nullopt);
+    EXPECT_TRUE(pq.empty());
+}
+
+TEST(TSPriorityQueueTest, CustomCompareAndEmplace) {
+    ts::priority_queue<std::string, std::greater<std::string>> pq(4);
+    pq.emplace(3, 'c');
+    pq.push("a");
+    pq.push("b");
+
+    std::vector<std::string> popped;
+    while (auto value = pq.try_pop()) popped.push_back(*value);
+    std::sort(popped.begin(), popped.end());
+    EXPECT_EQ(popped, (std::vector<std::string>{"a", "b", "ccc"}));
+}
+
+TEST(TSPriorityQueueTest, BlockingPopWaitsForPush) {
+    ts::priority_queue<int> pq(8);
+    std::atomic<bool> popped = false;
+
+    std::thread consumer([&] {
+        EXPECT_EQ(pq.pop(), 5);
+        popped = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(popped);
+    pq.push(5);
+    consumer.join();
+    EXPECT_TRUE(popped);
+}
+
+TEST(TSPriorityQueueTest, ConcurrentPushPopLosesNothing) {
+    ts::priority_queue<int> pq(8);
+    constexpr int threads = 4;
+    constexpr int items = 5000;
+
+    std::atomic<long long> sum = 0;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (int i = 1; i <= items; ++i) pq.push(i);
+        });
+        workers.emplace_back([&] {
+            for (int i = 0; i < items; ++i) sum += pq.pop();
+        });
+    }
+
+    for (auto& w : workers) w.join();
+    EXPECT_TRUE(pq.empty());
+    EXPECT_EQ(sum, static_cast<long long>(threads) * items * (items + 1) / 2);
+}
+
+// === ts::deque coroutine tests ===
+
+// Minimal eagerly started, self-destroying coroutine for driving awaitables.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+static DetachedTask pop_into(ts::deque<int>& d, std::optional<int>& out) {
+    out = co_await d.async_pop_front();
+}
+
+TEST(TSDequeCoroutineTest, ReadyElementDoesNotSuspend) {
+    ts::deque<int> d{7};
+    std::optional<int> result;
+    pop_into(d, result);
+    EXPECT_EQ(result, 7);
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(TSDequeCoroutineTest, PushResumesWaitersInArrivalOrder) {
+    ts::deque<int> d;
+    std::optional<int> first, second, third;
+    pop_into(d, first);
+    pop_into(d, second);
+    EXPECT_FALSE(first.has_value());
+
+    d.push_back(1);
+    EXPECT_EQ(first, 1);
+    EXPECT_FALSE(second.has_value());
+
+    pop_into(d, third);
+    d.append_range(std::vector<int>{2, 3, 4});
+    EXPECT_EQ(second, 2);
+    EXPECT_EQ(third, 3);
+    EXPECT_EQ(d.pop_front(), 4);
+}
+
+TEST(TSDequeCoroutineTest, ExecutorDecidesWhereToResume) {
+    ts::deque<std::string> d;
+    std::vector<std::coroutine_handle<>> scheduled;
+    std::optional<std::string> result;
+
+    auto consumer = [&]() -> DetachedTask {
+        result = co_await d.async_pop_front([&](std::coroutine_handle<> h) { scheduled.push_back(h); });
+    };
+    consumer();
+
+    d.push_back("hello");
+    EXPECT_FALSE(result.has_value());
+    ASSERT_EQ(scheduled.size(), 1);
+    EXPECT_TRUE(d.empty());
+
+    scheduled.front().resume();
+    EXPECT_EQ(result, "hello");
+}
+
+// Records the running coroutine's handle without suspending, so a test can destroy it later.
+struct CaptureHandle {
+    std::coroutine_handle<>& out;
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> h) noexcept { out = h; return false; }
+    void await_resume() const noexcept {}
+};
+
+static DetachedTask cancellable_pop_into(ts::deque<int>& d, std::optional<int>& out, std::coroutine_handle<>& self) {
+    co_await CaptureHandle{self};
+    out = co_await d.async_pop_front();
+}
+
+TEST(TSDequeCoroutineTest, DestroyedWaiterLeavesTheQueue) {
+    ts::deque<int> d;
+    std::optional<int> a, b, c, e;
+    std::coroutine_handle<> ha, hb, hc, he;
+    cancellable_pop_into(d, a, ha);
+    cancellable_pop_into(d, b, hb);
+    cancellable_pop_into(d, c, hc);
+    cancellable_pop_into(d, e, he);
+
+    ha.destroy(); // head
+    hc.destroy(); // middle
+    he.destroy(); // tail
+
+    d.push_back(1);
+    EXPECT_EQ(b, 1);
+    EXPECT_FALSE(a.has_value());
+    EXPECT_FALSE(c.has_value());
+    EXPECT_FALSE(e.has_value());
+
+    d.push_back(2);
+    EXPECT_EQ(d.size(), 1);
+
+    std::optional<int> f;
+    pop_into(d, f);
+    EXPECT_EQ(f, 2);
+
+    std::optional<int> g;
+    std::coroutine_handle<> hg;
+    cancellable_pop_into(d, g, hg);
+    hg.destroy(); // only waiter
+    d.push_back(3);
+    EXPECT_FALSE(g.has_value());
+    EXPECT_EQ(d.pop_front(), 3);
+}
+
+TEST(TSDequeCoroutineTest, ConcurrentProducersResumeEveryWaiter) {
+    ts::deque<int> d;
+    constexpr int waiters = 1000;
+    constexpr int producers = 4;
+
+    std::vector<std::optional<int>> results(waiters);
+    for (auto& result : results) pop_into(d, result);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&d, p] {
+            for (int i = 0; i < waiters / producers; ++i) d.push_back(p * (waiters / producers) + i + 1);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    long long sum = 0;
+    for (auto& result : results) {
+        ASSERT_TRUE(result.has_value());
+        sum += *result;
+    }
+    EXPECT_EQ(sum, static_cast<long long>(waiters) * (waiters + 1) / 2);
+    EXPECT_TRUE(d.empty());
+}
+
+// === ts::flat_combining_mutex tests ===
+
+TEST(TSFlatCombiningMutexTest, CombineReturnsValuesReferencesAndExceptions) {
+    ts::flat_combining_mutex mutex;
+    int counter = 0;
+
+    EXPECT_EQ(mutex.combine([&] { return ++counter; }), 1);
+
+    int& ref = mutex.combine([&]() -> int& { return counter; });
+    EXPECT_EQ(&ref, &counter);
+
+    EXPECT_THROW(mutex.combine([]() -> int { throw std::runtime_error("boom"); }), std::runtime_error);
+
+    // The lock is released after an exception, so plain locking still works.
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST(TSFlatCombiningMutexTest, OperationsPublishedWhileLockedRunExactlyOnce) {
+    ts::flat_combining_mutex mutex;
+    long long counter = 0;
+    constexpr int threads_count = 8;
+    constexpr int per_thread = 5000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < per_thread; ++i) {
+                if (i % 100 == 0) {
+                    std::lock_guard lock(mutex);
+                    ++counter;
+                } else {
+                    mutex.combine([&] { ++counter; });
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(counter, static_cast<long long>(threads_count) * per_thread);
+}
+
+TEST(TSFlatCombiningMutexTest, DequeWithCombiningLockKeepsEveryElement) {
+    ts::deque<int, std::allocator<int>, ts::flat_combining_mutex> d;
+    constexpr int producers = 4;
+    constexpr int per_producer = 10000;
+    std::atomic<long long> consumed_sum{0};
+    std::atomic<int> consumed{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 1; i <= per_producer; ++i) d.push_back(p * per_producer + i);
+        });
+        threads.emplace_back([&] {
+            while (consumed.load() < producers * per_producer) {
+                if (auto value = d.pop_front_nullable()) {
+                    consumed_sum += *value;
+                    ++consumed;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    const long long n = static_cast<long long>(producers) * per_producer;
+    EXPECT_EQ(consumed_sum.load(), n * (n + 1) / 2);
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(TSFlatCombiningMutexTest, DequeWithCombiningLockStillBlocksAndBoundsCapacity) {
+    ts::deque<int, std::allocator<int>, ts::flat_combining_mutex> d;
+    d.set_max_capacity(2);
+
+    std::thread producer([&] {
+        for (int i = 0; i < 100; ++i) d.push_back(i);
+    });
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_LE(d.size(), 2);
+        EXPECT_EQ(d.wait_pop_front(), i);
+    }
+    producer.join();
+    EXPECT_FALSE(d.try_pop_for(std::chrono::milliseconds(1)).has_value());
+}
+
+TEST(TSFlatCombiningMutexTest, VectorWithCombiningLockConcurrentPushBack) {
+    ts::vector<int, std::allocator<int>, ts::flat_combining_mutex> vec;
+    constexpr int threads_count = 8;
+    constexpr int per_thread = 2000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) vec.emplace_back(t * per_thread + i);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    auto data = vec.snapshot();
+    std::sort(data.begin(), data.end());
+    ASSERT_EQ(data.size(), static_cast<size_t>(threads_count * per_thread));
+    for (int i = 0; i < threads_count * per_thread; ++i) EXPECT_EQ(data[i], i);
+}
+
+// === Shared (reader) locking tests ===
+
+// Both callbacks must be inside read() at the same time for either to finish.
+template <class Container>
+static void expect_readers_overlap(const Container& container) {
+    std::atomic<int> inside{0};
+    std::atomic<bool> overlapped{false};
+
+    auto reader = [&] {
+        container.read([&](const auto&) {
+            ++inside;
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (inside.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            if (inside.load() == 2) overlapped = true;
+        });
+    };
+
+    std::thread first(reader);
+    std::thread second(reader);
+    first.join();
+    second.join();
+    EXPECT_TRUE(overlapped.load());
+}
+
+TEST(TSSharedLockTest, VectorReadersRunConcurrently) {
+    ts::vector<int, std::allocator<int>, std::shared_mutex> vec{1, 2, 3};
+    expect_readers_overlap(vec);
+}
+
+TEST(TSSharedLockTest, DequeReadersRunConcurrently) {
+    ts::deque<int, std::allocator<int>, std::shared_mutex> d{1, 2, 3};
+    expect_readers_overlap(d);
+}
+
+TEST(TSSharedLockTest, ReadReturnsCallbackResult) {
+    ts::vector<int> vec{1, 2, 3, 4};
+    int sum = vec.read([](const std::vector<int>& data) { return std::accumulate(data.begin(), data.end(), 0); });
+    EXPECT_EQ(sum, 10);
+
+    ts::deque<std::string> d{"a", "bc"};
+    size_t first_size = d.read([](const std::deque<std::string>& data) { return data.front().size(); });
+    EXPECT_EQ(first_size, 1);
+}
+
+TEST(TSSharedLockTest, ExclusiveLockTypesStillWork) {
+    ts::vector<int, std::allocator<int>, std::mutex> vec{1, 2};
+    EXPECT_EQ(vec.read([](const auto& data) { return data.size(); }), 2);
+    EXPECT_EQ(vec.size(), 2);
+
+    ts::deque<int, std::allocator<int>, std::mutex> d;
+    std::thread producer([&] { d.push_back(42); });
+    EXPECT_EQ(d.wait_pop_front(), 42);
+    producer.join();
+}
+
+TEST(TSSharedLockTest, ReadersSeeConsistentStateWhileWriting) {
+    ts::vector<int, std::allocator<int>, std::shared_mutex> vec;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&] {
+        for (int i = 0; i < 5000; ++i) {
+            vec.process([i](std::vector<int>& data) {
+                data.push_back(i);
+                data.push_back(-i);
+            });
+        }
+        done = true;
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                int sum = vec.read([](const std::vector<int>& data) {
+                    return std::accumulate(data.begin(), data.end(), 0);
+                });
+                EXPECT_EQ(sum, 0);
+                EXPECT_EQ(vec.size() % 2, 0);
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& t : readers) t.join();
+}
+
+// === Lock policy tests ===
+
+template <class LockPolicy>
+class TSLockPolicyTest : public ::testing::Test {};
+
+using ThreadSafeLockPolicies =
+    ::testing::Types<std::mutex, std::shared_mutex, ts::spinlock, ts::adaptive_mutex, ts::flat_combining_mutex>;
+TYPED_TEST_SUITE(TSLockPolicyTest, ThreadSafeLockPolicies);
+
+TYPED_TEST(TSLockPolicyTest, ProvidesMutualExclusion) {
+    TypeParam mutex;
+    long long counter = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                std::lock_guard lock(mutex);
+                ++counter;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(counter, 40000);
+    ASSERT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TYPED_TEST(TSLockPolicyTest, ContainersWorkWithEveryPolicy) {
+    ts::vector<int, std::allocator<int>, TypeParam> vec;
+    ts::deque<int, std::allocator<int>, TypeParam> d;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 1000; ++i) {
+                vec.push_back(t * 1000 + i);
+                d.push_back(t * 1000 + i);
+            }
+        });
+    }
+    long long popped_sum = 0;
+    for (int i = 0; i < 4000; ++i) popped_sum += d.wait_pop_front();
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(vec.size(), 4000);
+    EXPECT_EQ(popped_sum, 3999LL * 4000 / 2);
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(TSNullMutexTest, SingleThreadedContainers) {
+    ts::vector<int, std::allocator<int>, ts::null_mutex> vec{1, 2, 3};
+    vec.push_back(4);
+    EXPECT_EQ(vec.read([](const auto& data) { return std::accumulate(data.begin(), data.end(), 0); }), 10);
+
+    ts::deque<int, std::allocator<int>, ts::null_mutex> d;
+    d.push_back(1);
+    d.push_front(0);
+    EXPECT_EQ(d.pop_front(), 0);
+    EXPECT_EQ(d.pop_front_nullable(), 1);
+    EXPECT_FALSE(d.pop_front_nullable().has_value());
+}
+
+// === ts::cow_vector tests ===
+
+TEST(TSCowVectorTest, SnapshotIsSharedUntilWrite) {
+    ts::cow_vector<int> vec{1, 2, 3};
+    auto first = vec.snapshot();
+    auto second = vec.snapshot();
+    EXPECT_EQ(first.get(), second.get());
+
+    vec.push_back(4);
+    auto third = vec.snapshot();
+    EXPECT_NE(first.get(), third.get());
+    EXPECT_EQ(*first, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(*third, (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(TSCowVectorTest, WritesWithoutLiveSnapshotsDoNotClone) {
+    ts::cow_vector<int> vec;
+    vec.reserve(16);
+    const int* before = vec.snapshot()->data();
+
+    for (int i = 0; i < 10; ++i) vec.push_back(i);
+    EXPECT_EQ(vec.snapshot()->data(), before);
+    EXPECT_EQ(vec.size(), 10);
+}
+
+TEST(TSCowVectorTest, EveryWriterKindLeavesSnapshotsUntouched) {
+    ts::cow_vector<int> vec{5, 1, 4, 2, 3};
+    auto original = vec.snapshot();
+
+    vec.erase_if([](int x) { return x % 2 == 0; });
+    vec.process([](std::vector<int>& data) { std::sort(data.begin(), data.end()); });
+    vec.append_range(std::vector<int>{7, 9});
+    vec.emplace_back(11);
+    vec.pop_back();
+
+    EXPECT_EQ(*original, (std::vector<int>{5, 1, 4, 2, 3}));
+    EXPECT_EQ(*vec.snapshot(), (std::vector<int>{1, 3, 5, 7, 9}));
+
+    auto before_clear = vec.snapshot();
+    vec.clear();
+    EXPECT_TRUE(vec.empty());
+    EXPECT_EQ(before_clear->size(), 5);
+}
+
+TEST(TSCowVectorTest, CopiesShareBufferButNotWrites) {
+    ts::cow_vector<std::string> a{"x", "y"};
+    ts::cow_vector<std::string> b(a);
+    EXPECT_EQ(a.snapshot().get(), b.snapshot().get());
+
+    b.push_back("z");
+    EXPECT_EQ(a.size(), 2);
+    EXPECT_EQ(b.size(), 3);
+    EXPECT_EQ(a.read([](const auto& data) { return data.back(); }), "y");
+}
+
+TEST(TSCowVectorTest, ConcurrentSnapshotsAlwaysSeeCompleteWrites) {
+    ts::cow_vector<int> vec;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&] {
+        for (int i = 0; i < 2000; ++i) {
+            vec.process([i](std::vector<int>& data) {
+                data.push_back(i);
+                data.push_back(-i);
+            });
+        }
+        done = true;
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                auto snap = vec.snapshot();
+                EXPECT_EQ(snap->size() % 2, 0);
+                EXPECT_EQ(std::accumulate(snap->begin(), snap->end(), 0), 0);
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& t : readers) t.join();
+    EXPECT_EQ(vec.size(), 4000);
+}
+
+// === Epoch reclamation / ts::read_mostly_vector tests ===
+
+TEST(TSEpochTest, RetiredObjectOutlivesActiveReader) {
+    static std::atomic<int> deleted{0};
+    deleted = 0;
+    auto& domain = ts::detail::epoch_domain::instance();
+
+    std::atomic<bool> reader_inside{false};
+    std::atomic<bool> release_reader{false};
+    std::thread reader([&] {
+        ts::detail::epoch_guard guard;
+        reader_inside = true;
+        while (!release_reader.load()) std::this_thread::yield();
+    });
+    while (!reader_inside.load()) std::this_thread::yield();
+
+    int dummy = 0;
+    domain.retire(&dummy, [](void*) { ++deleted; });
+    for (int i = 0; i < 10; ++i) domain.reclaim();
+    EXPECT_EQ(deleted.load(), 0);
+
+    release_reader = true;
+    reader.join();
+    for (int i = 0; i < 10 && deleted.load() == 0; ++i) domain.reclaim();
+    EXPECT_EQ(deleted.load(), 1);
+}
+
+TEST(TSReadMostlyVectorTest, BasicOperations) {
+    ts::read_mostly_vector<int> vec{3, 1, 2};
+    vec.push_back(4);
+    vec.emplace_back(5);
+    vec.append_range(std::vector<int>{6, 7});
+    vec.erase_if([](int x) { return x % 2 == 0; });
+    vec.pop_back();
+
+    EXPECT_EQ(vec.snapshot(), (std::vector<int>{3, 1, 5}));
+    EXPECT_EQ(vec.read([](const std::vector<int>& data) { return data.front(); }), 3);
+
+    vec.update([](std::vector<int>& data) { std::sort(data.begin(), data.end()); });
+    EXPECT_EQ(vec.snapshot(), (std::vector<int>{1, 3, 5}));
+
+    vec.assign({9});
+    EXPECT_EQ(vec.size(), 1);
+    vec.clear();
+    EXPECT_TRUE(vec.empty());
+}
+
+TEST(TSReadMostlyVectorTest, ReadersAlwaysSeeWholeVersions) {
+    ts::read_mostly_vector<int> vec;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&] {
+        for (int i = 1; i <= 2000; ++i) {
+            vec.update([i](std::vector<int>& data) {
+                data.push_back(i);
+                data.push_back(-i);
+            });
+        }
+        done = true;
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            size_t last_size = 0;
+            while (!done.load()) {
+                auto [size, sum] = vec.read([](const std::vector<int>& data) {
+                    return std::pair{data.size(), std::accumulate(data.begin(), data.end(), 0)};
+                });
+                EXPECT_EQ(size % 2, 0);
+                EXPECT_EQ(sum, 0);
+                EXPECT_GE(size, last_size);
+                last_size = size;
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& t : readers) t.join();
+    EXPECT_EQ(vec.size(), 4000);
+}
+
+TEST(TSReadMostlyVectorTest, OldVersionsAreReclaimed) {
+    struct Counted {
+        explicit Counted(std::atomic<int>& live) : live(&live) { ++live; }
+        Counted(const Counted& other) : live(other.live) { ++*live; }
+        ~Counted() { --*live; }
+        std::atomic<int>* live;
+    };
+
+    std::atomic<int> live{0};
+    {
+        ts::read_mostly_vector<Counted> vec;
+        for (int i = 0; i < 100; ++i) vec.emplace_back(live);
+        for (int i = 0; i < 10; ++i) ts::detail::epoch_domain::instance().reclaim();
+        // Only the current version (100 elements) survives once no reader is active.
+        EXPECT_EQ(live.load(), 100);
+    }
+    EXPECT_EQ(live.load(), 0);
+}
+
+// === ts::concurrent_vector tests ===
+
+TEST(TSConcurrentVectorTest, IndicesAndReferencesStayValidAcrossGrowth) {
+    ts::concurrent_vector<std::string> vec;
+    std::string& first = vec.emplace_back("first");
+    const std::string* first_address = &first;
+
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(vec.push_back(std::to_string(i)), static_cast<size_t>(i + 1));
+    }
+
+    EXPECT_EQ(&vec[0], first_address);
+    EXPECT_EQ(first, "first");
+    EXPECT_EQ(vec[5001], "5000");
+    EXPECT_EQ(vec.size(), 10001);
+}
+
+TEST(TSConcurrentVectorTest, AppendRangeReservesContiguousIndices) {
+    ts::concurrent_vector<int> vec;
+    vec.push_back(-1);
+    size_t first = vec.append_range(std::vector<int>{10, 20, 30});
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(vec.snapshot(), (std::vector<int>{-1, 10, 20, 30}));
+
+    EXPECT_THROW((void)vec.at(4), std::out_of_range);
+    EXPECT_EQ(vec.at(3), 30);
+}
+
+TEST(TSConcurrentVectorTest, FailedConstructionIsSkipped) {
+    struct Fragile {
+        explicit Fragile(int v) : value(v) {
+            if (v < 0) throw std::runtime_error("negative");
+        }
+        int value;
+    };
+
+    ts::concurrent_vector<Fragile> vec;
+    vec.emplace_back(1);
+    EXPECT_THROW(vec.emplace_back(-1), std::runtime_error);
+    vec.emplace_back(2);
+
+    EXPECT_EQ(vec.size(), 3);
+    EXPECT_THROW((void)vec.at(1), std::out_of_range);
+    int sum = 0;
+    vec.for_each([&](const Fragile& f) { sum += f.value; });
+    EXPECT_EQ(sum, 3);
+}
+
+TEST(TSConcurrentVectorTest, ThrowInsideAppendRangeMarksTheRestOfTheRunFailed) {
+    struct Fragile {
+        explicit Fragile(int v) : value(v) {
+            if (v < 0) throw std::runtime_error("negative");
+        }
+        int value;
+    };
+
+    ts::concurrent_vector<Fragile> vec;
+    vec.emplace_back(1);
+    std::vector<int> source{2, 3, -1, 4, 5};
+    EXPECT_THROW(vec.append_range(source | std::views::transform([](int v) { return Fragile(v); })),
+                 std::runtime_error);
+    vec.emplace_back(6);
+
+    // Indices 3 (the throw) and 4, 5 (never reached) are failed, not left pending forever.
+    EXPECT_EQ(vec.size(), 7u);
+    EXPECT_EQ(vec.at(2).value, 3);
+    for (size_t i = 3; i < 6; ++i) EXPECT_THROW((void)vec.at(i), std::out_of_range);
+    std::vector<int> seen;
+    vec.for_each([&](const Fragile& f) { seen.push_back(f.value); });
+    EXPECT_EQ(seen, (std::vector<int>{1, 2, 3, 6}));
+}
+
+TEST(TSConcurrentVectorTest, OversizedReservationPublishesNothing) {
+    ts::concurrent_vector<int> vec;
+    vec.push_back(1);
+    EXPECT_THROW(vec.append_range(std::views::iota(size_t{0}, std::numeric_limits<size_t>::max())),
+                 std::length_error);
+    EXPECT_EQ(vec.size(), 1u);
+    vec.push_back(2);
+    EXPECT_EQ(vec.snapshot(), (std::vector<int>{1, 2}));
+}
+
+TEST(TSConcurrentVectorTest, ConcurrentAppendsAndReads) {
+    ts::concurrent_vector<size_t> vec;
+    vec.reserve(100);
+    constexpr int threads_count = 8;
+    constexpr int per_thread = 5000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < per_thread; ++i) {
+                size_t index = vec.size();
+                size_t& element = vec.emplace_back(0);
+                element = 1;
+                // Any index below what size() reported earlier is readable through at().
+                if (index > 0) {
+                    (void)vec.at(index - 1);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    ASSERT_EQ(vec.size(), static_cast<size_t>(threads_count * per_thread));
+    size_t total = 0;
+    vec.for_each([&](size_t v) { total += v; });
+    EXPECT_EQ(total, static_cast<size_t>(threads_count * per_thread));
+}
+
+// === ts::vector::snapshot_since tests ===
+
+TEST(TSVectorTest, SnapshotSinceReturnsOnlyAppendedTail) {
+    ts::vector<int> vec{1, 2};
+    auto first = vec.snapshot_since({});
+    EXPECT_FALSE(first.invalidated);
+    EXPECT_EQ(first.elements, (std::vector<int>{1, 2}));
+
+    vec.push_back(3);
+    vec.append_range(std::vector<int>{4, 5});
+    vec.resize(6, 6);
+    auto second = vec.snapshot_since(first.next);
+    EXPECT_FALSE(second.invalidated);
+    EXPECT_EQ(second.elements, (std::vector<int>{3, 4, 5, 6}));
+
+    auto third = vec.snapshot_since(second.next);
+    EXPECT_FALSE(third.invalidated);
+    EXPECT_TRUE(third.elements.empty());
+}
+
+TEST(TSVectorTest, SnapshotSinceReportsInvalidation) {
+    ts::vector<int> vec{1, 2, 3, 4};
+    auto start = vec.snapshot_since({}).next;
+
+    // An erase that removes nothing leaves the cursor usable.
+    vec.erase_if([](int x) { return x > 100; });
+    EXPECT_FALSE(vec.snapshot_since(start).invalidated);
+
+    vec.erase_if([](int x) { return x % 2 == 0; });
+    vec.push_back(5);
+    auto after_erase = vec.snapshot_since(start);
+    EXPECT_TRUE(after_erase.invalidated);
+    EXPECT_EQ(after_erase.elements, (std::vector<int>{1, 3, 5}));
+
+    vec.clear();
+    auto after_clear = vec.snapshot_since(after_erase.next);
+    EXPECT_TRUE(after_clear.invalidated);
+    EXPECT_TRUE(after_clear.elements.empty());
+
+    vec.push_back(7);
+    vec.process([](std::vector<int>& data) { data[0] = 8; });
+    auto after_process = vec.snapshot_since(after_clear.next);
+    EXPECT_TRUE(after_process.invalidated);
+    EXPECT_EQ(after_process.elements, (std::vector<int>{8}));
+}
+
+TEST(TSVectorTest, PollingWithSnapshotSinceRebuildsContents) {
+    ts::vector<int> vec;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&] {
+        for (int i = 0; i < 5000; ++i) {
+            vec.push_back(i);
+            if (i % 1000 == 999) vec.erase_if([](int x) { return x % 2 == 1; });
+        }
+        done = true;
+    });
+
+    std::vector<int> view;
+    ts::vector<int>::cursor position;
+    auto poll = [&] {
+        auto d = vec.snapshot_since(position);
+        if (d.invalidated) view.clear();
+        view.insert(view.end(), d.elements.begin(), d.elements.end());
+        position = d.next;
+    };
+    while (!done.load()) poll();
+    writer.join();
+    poll();
+
+    EXPECT_EQ(view, vec.snapshot());
+}
+
+// --- Parallel bulk operations ---
+
+TEST(TSVectorParallelTest, EraseIfMatchesSequentialOrder) {
+    std::vector<int> expected(100000);
+    std::iota(expected.begin(), expected.end(), 0);
+    ts::vector<int> vec(expected);
+
+    vec.erase_if(ts::parallel_policy{.threshold = 0, .max_threads = 7}, [](int x) { return x % 3 == 0; });
+    std::erase_if(expected, [](int x) { return x % 3 == 0; });
+
+    EXPECT_EQ(vec.snapshot(), expected);
+}
+
+TEST(TSVectorParallelTest, EraseIfBelowThresholdRunsSequentially) {
+    ts::vector<int> vec{1, 2, 3, 4, 5};
+    std::thread::id caller = std::this_thread::get_id();
+    bool other_thread = false;
+
+    vec.erase_if(ts::parallel_policy{}, [&](int x) {
+        other_thread |= std::this_thread::get_id() != caller;
+        return x > 3;
+    });
+
+    EXPECT_FALSE(other_thread);
+    EXPECT_EQ(vec.snapshot(), (std::vector<int>{1, 2, 3}));
+}
+
+TEST(TSVectorParallelTest, EraseIfInvalidatesCursorsOnlyWhenRemoving) {
+    ts::vector<int> vec{1, 2, 3, 4, 5, 6, 7, 8};
+    ts::parallel_policy policy{.threshold = 0, .max_threads = 3};
+    auto start = vec.snapshot_since({}).next;
+
+    vec.erase_if(policy, [](int x) { return x > 100; });
+    EXPECT_FALSE(vec.snapshot_since(start).invalidated);
+
+    vec.erase_if(policy, [](int x) { return x % 2 == 0; });
+    auto after = vec.snapshot_since(start);
+    EXPECT_TRUE(after.invalidated);
+    EXPECT_EQ(after.elements, (std::vector<int>{1, 3, 5, 7}));
+}
+
+TEST(TSVectorParallelTest, ForEachAndTransformVisitEveryElement) {
+    ts::vector<int> vec(std::vector<int>(50000, 1));
+    ts::parallel_policy policy{.threshold = 0, .max_threads = 4};
+
+    vec.for_each(policy, [](int& x) { x += 1; });
+    vec.transform(policy, [](int x) { return x * 10; });
+
+    vec.read([](const std::vector<int>& data) {
+        EXPECT_TRUE(std::all_of(data.begin(), data.end(), [](int x) { return x == 20; }));
+    });
+}
+
+TEST(TSVectorParallelTest, SortWithUnevenChunks) {
+    std::vector<int> input(12345);
+    std::mt19937 rng(42);
+    for (int& x : input) x = static_cast<int>(rng() % 1000);
+
+    for (unsigned threads : {2u, 3u, 5u, 8u}) {
+        ts::vector<int> vec(input);
+        vec.sort(ts::parallel_policy{.threshold = 0, .max_threads = threads}, std::greater<>{});
+
+        std::vector<int> expected = input;
+        std::sort(expected.begin(), expected.end(), std::greater<>{});
+        EXPECT_EQ(vec.snapshot(), expected) << threads << " threads";
+    }
+}
+
+TEST(TSVectorParallelTest, ExceptionFromCallbackPropagates) {
+    ts::vector<int> vec(std::vector<int>(1000, 0));
+    vec.push_back(1);
+
+    EXPECT_THROW(vec.for_each(ts::parallel_policy{.threshold = 0, .max_threads = 4},
+                              [](int& x) {
+                                  if (x == 1) throw std::runtime_error("bad element");
+                              }),
+                 std::runtime_error);
+
+    // The lock was released and the pool is still usable.
+    vec.erase_if(ts::parallel_policy{.threshold = 0, .max_threads = 4}, [](int x) { return x == 1; });
+    EXPECT_EQ(vec.size(), 1000u);
+}
+
+// --- SIMD erase_if kernels ---
+
+template <typename T>
+class TSFilterKernelTest : public ::testing::Test {};
+
+using FilterElementTypes = ::testing::Types<int32_t, uint32_t, int64_t, uint64_t, float, double>;
+TYPED_TEST_SUITE(TSFilterKernelTest, FilterElementTypes);
+
+template <typename T, typename Pred>
+void expect_kernels_match_scalar(const std::vector<T>& input, const Pred& pred) {
+    std::vector<T> expected = input;
+    expected.erase(std::remove_if(expected.begin(), expected.end(), pred), expected.end());
+
+    for (auto level : {ts::detail::simd_level::scalar, ts::detail::simd_level::avx2, ts::detail::simd_level::avx512}) {
+        if (level > ts::detail::detected_simd_level()) continue;
+        std::vector<T> data = input;
+        T* end = ts::detail::simd_remove_if(data.data(), data.data() + data.size(), pred, level);
+        data.resize(static_cast<size_t>(end - data.data()));
+        // NaN never compares equal to itself, so compare element-wise with NaN matching NaN.
+        EXPECT_TRUE(std::ranges::equal(data, expected, [](T x, T y) { return x == y || (x != x && y != y); }))
+            << "level " << static_cast<int>(level);
+    }
+}
+
+TYPED_TEST(TSFilterKernelTest, AllPredicatesMatchScalarResult) {
+    using T = TypeParam;
+    std::mt19937 rng(7);
+    // Odd length so every kernel also runs its scalar tail.
+    std::vector<T> input(1003);
+    for (T& x : input) x = static_cast<T>(rng() % 200);
+    if constexpr (std::is_signed_v<T>) input[5] = static_cast<T>(-50);
+    if constexpr (std::is_unsigned_v<T>) input[6] = std::numeric_limits<T>::max();
+
+    expect_kernels_match_scalar(input, ts::pred::less{T(100)});
+    expect_kernels_match_scalar(input, ts::pred::less_equal{T(100)});
+    expect_kernels_match_scalar(input, ts::pred::greater{T(100)});
+    expect_kernels_match_scalar(input, ts::pred::greater_equal{T(100)});
+    expect_kernels_match_scalar(input, ts::pred::equal_to{T(7)});
+    expect_kernels_match_scalar(input, ts::pred::not_equal_to{T(7)});
+    expect_kernels_match_scalar(input, ts::pred::in_range{T(20), T(150)});
+    if constexpr (std::is_integral_v<T>) {
+        expect_kernels_match_scalar(input, ts::pred::any_bits{T(5)});
+    }
+}
+
+TEST(TSFilterTest, FloatNanNeverMatchesOrderedComparisons) {
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> input{1.0f, nan, 3.0f, nan, 5.0f, 6.0f, nan, 8.0f, 9.0f, nan};
+
+    expect_kernels_match_scalar(input, ts::pred::less{5.0f});
+    expect_kernels_match_scalar(input, ts::pred::greater_equal{5.0f});
+    expect_kernels_match_scalar(input, ts::pred::in_range{2.0f, 8.0f});
+    expect_kernels_match_scalar(input, ts::pred::not_equal_to{3.0f});
+}
+
+TEST(TSFilterTest, VectorEraseIfWithPredicateObjects) {
+    ts::vector<int> ints;
+    for (int i = 0; i < 100; ++i) ints.push_back(i);
+    ints.erase_if(ts::pred::greater_equal{10});
+    ints.erase_if(ts::pred::any_bits{1});
+    EXPECT_EQ(ints.snapshot(), (std::vector<int>{0, 2, 4, 6, 8}));
+
+    // A plain int literal bound works for unsigned and floating-point elements too.
+    ts::vector<uint64_t> big{1, 5, 10, std::numeric_limits<uint64_t>::max()};
+    big.erase_if(ts::pred::less{6});
+    EXPECT_EQ(big.snapshot(), (std::vector<uint64_t>{10, std::numeric_limits<uint64_t>::max()}));
+
+    ts::vector<float> floats{0.5f, 1.5f, 2.5f};
+    floats.erase_if(ts::pred::in_range{1, 2});
+    EXPECT_EQ(floats.snapshot(), (std::vector<float>{0.5f, 2.5f}));
+}
+
+TEST(TSFilterTest, WideningOperandKeepsScalarSemantics) {
+    // x < 2.5 compares in double, so 2 is removed; the kernels would truncate the bound to 2.
+    static_assert(!ts::detail::simd_filter<int, ts::pred::less<double>>);
+    ts::vector<int> vec{1, 2, 3};
+    vec.erase_if(ts::pred::less{2.5});
+    EXPECT_EQ(vec.snapshot(), (std::vector<int>{3}));
+
+    // Mixed signedness compares in unsigned, exactly like the built-in operator.
+    static_assert(!ts::detail::simd_filter<int32_t, ts::pred::less<uint32_t>>);
+    ts::vector<int32_t> mixed{-1, 1};
+    mixed.erase_if(ts::pred::less{2u});
+    EXPECT_EQ(mixed.snapshot(), (std::vector<int32_t>{-1}));
+}
+
+TEST(TSFilterTest, OtherContainersUseKernels) {
+    ts::cow_vector<int> cow{1, 2, 3, 4};
+    auto before = cow.snapshot();
+    cow.erase_if(ts::pred::greater{2});
+    EXPECT_EQ(*cow.snapshot(), (std::vector<int>{1, 2}));
+    EXPECT_EQ(*before, (std::vector<int>{1, 2, 3, 4}));
+
+    ts::read_mostly_vector<double> rm{0.1, 0.2, 0.3};
+    rm.erase_if(ts::pred::equal_to{0.2});
+    EXPECT_EQ(rm.snapshot(), (std::vector<double>{0.1, 0.3}));
+
+    ts::vector<int> parallel(std::vector<int>(5000, 1));
+    parallel.push_back(2);
+    parallel.erase_if(ts::parallel_policy{.threshold = 0, .max_threads = 3}, ts::pred::equal_to{1});
+    EXPECT_EQ(parallel.snapshot(), (std::vector<int>{2}));
+}
+
+// --- snapshot_into / snapshot_pool ---
+
+TEST(TSSnapshotIntoTest, VectorReusesCallerCapacity) {
+    ts::vector<int> vec{1, 2, 3};
+    std::vector<int> out;
+
+    vec.snapshot_into(out);
+    EXPECT_EQ(out, (std::vector<int>{1, 2, 3}));
+
+    out.reserve(64);
+    const int* buffer = out.data();
+    vec.push_back(4);
+    vec.snapshot_into(out);
+    EXPECT_EQ(out, (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_EQ(out.data(), buffer);
+
+    vec.clear();
+    vec.snapshot_into(out);
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(out.capacity(), 64u);
+}
+
+TEST(TSSnapshotIntoTest, SpanReportsTruncation) {
+    ts::vector<int> vec{1, 2, 3, 4, 5};
+    std::array<int, 3> small{};
+    EXPECT_EQ(vec.snapshot_into(std::span<int>(small)), 5u);
+    EXPECT_EQ(small, (std::array<int, 3>{1, 2, 3}));
+
+    std::array<int, 8> large{};
+    EXPECT_EQ(vec.snapshot_into(std::span<int>(large)), 5u);
+    EXPECT_EQ(large[4], 5);
+}
+
+TEST(TSSnapshotIntoTest, EraseIfThenSnapshotInto) {
+    ts::vector<int> vec{1, 2, 3, 4, 5, 6};
+    std::vector<int> out{9, 9};
+    vec.erase_if_then_snapshot_into([](int x) { return x % 2 == 0; }, out);
+    EXPECT_EQ(out, (std::vector<int>{1, 3, 5}));
+    EXPECT_EQ(vec.snapshot(), out);
+}
+
+TEST(TSSnapshotIntoTest, DequeSnapshotInto) {
+    ts::deque<int> dq;
+    for (int i = 0; i < 10; ++i) dq.push_back(i);
+
+    std::vector<int> out;
+    dq.snapshot_into(out);
+    EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    EXPECT_EQ(dq.size(), 10u);
+
+    std::array<int, 4> head{};
+    EXPECT_EQ(dq.snapshot_into(std::span<int>(head)), 10u);
+    EXPECT_EQ(head, (std::array<int, 4>{0, 1, 2, 3}));
+}
+
+TEST(TSSnapshotIntoTest, SnapshotIntoWhileGrowing) {
+    ts::vector<int> vec;
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int i = 0; i < 20000; ++i) vec.push_back(i);
+        done = true;
+    });
+
+    std::vector<int> out;
+    while (!done.load()) {
+        vec.snapshot_into(out);
+        for (size_t i = 0; i < out.size(); ++i) ASSERT_EQ(out[i], static_cast<int>(i));
+    }
+    writer.join();
+    vec.snapshot_into(out);
+    EXPECT_EQ(out.size(), 20000u);
+}
+
+TEST(TSSnapshotPoolTest, BuffersAreRecycled) {
+    ts::vector<int> vec{1, 2, 3};
+    ts::snapshot_pool<int> pool(2);
+
+    const int* first_buffer = nullptr;
+    {
+        auto snap = pool.take(vec);
+        EXPECT_EQ(*snap, (std::vector<int>{1, 2, 3}));
+        first_buffer = snap->data();
+    }
+    EXPECT_EQ(pool.idle(), 1u);
+
+    vec.pop_back();
+    auto snap = pool.take(vec);
+    EXPECT_EQ(*snap, (std::vector<int>{1, 2}));
+    EXPECT_EQ(snap->data(), first_buffer);
+    EXPECT_EQ(pool.idle(), 0u);
+}
+
+TEST(TSSnapshotPoolTest, KeepsAtMostMaxIdleBuffers) {
+    ts::deque<int> dq;
+    dq.push_back(7);
+    ts::snapshot_pool<int> pool(1);
+    {
+        auto a = pool.take(dq);
+        auto b = pool.take(dq);
+        auto moved = std::move(b);
+        EXPECT_EQ(moved[0], 7);
+    }
+    EXPECT_EQ(pool.idle(), 1u);
+}
+
+// --- ts::unordered_map ---
+
+TEST(TSUnorderedMapTest, BasicOperations) {
+    ts::unordered_map<std::string, int> map;
+    EXPECT_TRUE(map.empty());
+
+    EXPECT_TRUE(map.insert_or_assign("a", 1));
+    EXPECT_FALSE(map.insert_or_assign("a", 2));
+    EXPECT_TRUE(map.try_emplace("b", 3));
+    EXPECT_FALSE(map.try_emplace("b", 4));
+
+    EXPECT_EQ(map.find("a"), 2);
+    EXPECT_EQ(map.find("b"), 3);
+    EXPECT_EQ(map.find("c"), std::nullopt);
+    EXPECT_TRUE(map.contains("a"));
+    EXPECT_EQ(map.size(), 2u);
+
+    EXPECT_TRUE(map.update("a", [](int& v) { v += 10; }));
+    EXPECT_FALSE(map.update("c", [](int&) { FAIL(); }));
+    EXPECT_EQ(map.find("a"), 12);
+
+    int seen = 0;
+    EXPECT_TRUE(map.visit("b", [&](const int& v) { seen = v; }));
+    EXPECT_EQ(seen, 3);
+
+    EXPECT_EQ(map.erase("a"), 1u);
+    EXPECT_EQ(map.erase("a"), 0u);
+    map.clear();
+    EXPECT_TRUE(map.empty());
+}
+
+TEST(TSUnorderedMapTest, WholeTableOperations) {
+    ts::unordered_map<int, int> map(8);
+    EXPECT_EQ(map.stripe_count(), 8u);
+    map.reserve(1000);
+    for (int i = 0; i < 1000; ++i) map.insert_or_assign(i, i * i);
+
+    EXPECT_EQ(map.erase_if([](const auto& entry) { return entry.first % 2 == 1; }), 500u);
+    EXPECT_EQ(map.size(), 500u);
+
+    map.process([](auto& entry) { entry.second = -entry.second; });
+    long long sum = 0;
+    map.for_each([&](const auto& entry) { sum += entry.second; });
+
+    auto snap = map.snapshot();
+    EXPECT_EQ(snap.size(), 500u);
+    long long expected = 0;
+    for (int i = 0; i < 1000; i += 2) expected -= static_cast<long long>(i) * i;
+    EXPECT_EQ(sum, expected);
+    EXPECT_EQ(snap.at(10), -100);
+}
+
+TEST(TSUnorderedMapTest, ConcurrentUpdatesAreAtomic) {
+    ts::unordered_map<int, int, std::hash<int>, std::equal_to<int>, std::allocator<std::pair<const int, int>>,
+                      std::shared_mutex>
+        map;
+    const int keys = 64;
+    for (int k = 0; k < keys; ++k) map.insert_or_assign(k, 0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                map.update((i + t) % keys, [](int& v) { ++v; });
+                map.try_emplace(1000 + t * 2000 + i, i);
+                (void)map.find(i % keys);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    int total = 0;
+    for (int k = 0; k < keys; ++k) total += *map.find(k);
+    EXPECT_EQ(total, 8 * 2000);
+    EXPECT_EQ(map.size(), static_cast<size_t>(keys + 8 * 2000));
+}
+
+TEST(TSUnorderedMapTest, SingleStripeAndInitializerList) {
+    ts::unordered_map<int, std::string> single(1);
+    single.insert_or_assign(1, "one");
+    EXPECT_EQ(single.find(1), "one");
+
+    ts::unordered_map<int, int> init{{1, 10}, {2, 20}, {1, 99}};
+    EXPECT_EQ(init.size(), 2u);
+    EXPECT_EQ(init.find(2), 20);
+    EXPECT_EQ(init.find(1), 10); // first duplicate wins, as in std::unordered_map
+}
+
+// --- ts::ordered_map ---
+
+TEST(TSOrderedMapTest, BasicOperations) {
+    ts::ordered_map<int, std::string> map;
+    EXPECT_TRUE(map.empty());
+
+    EXPECT_TRUE(map.insert(5, "five"));
+    EXPECT_TRUE(map.insert(1, "one"));
+    EXPECT_TRUE(map.insert(3, "three"));
+    EXPECT_FALSE(map.insert(3, "drei"));
+    EXPECT_EQ(map.find(3), "three");
+
+    EXPECT_FALSE(map.insert_or_assign(3, "drei"));
+    EXPECT_EQ(map.find(3), "drei");
+    EXPECT_TRUE(map.insert_or_assign(4, "four"));
+    EXPECT_EQ(map.size(), 4u);
+
+    EXPECT_TRUE(map.contains(1));
+    EXPECT_FALSE(map.contains(2));
+    EXPECT_EQ(map.find(2), std::nullopt);
+
+    EXPECT_EQ(map.lower_bound(2), (std::pair<int, std::string>{3, "drei"}));
+    EXPECT_EQ(map.lower_bound(6), std::nullopt);
+
+    EXPECT_TRUE(map.erase(3));
+    EXPECT_FALSE(map.erase(3));
+    EXPECT_EQ(map.lower_bound(2), (std::pair<int, std::string>{4, "four"}));
+
+    auto snap = map.snapshot();
+    EXPECT_EQ(snap, (std::vector<std::pair<int, std::string>>{{1, "one"}, {4, "four"}, {5, "five"}}));
+}
+
+TEST(TSOrderedMapTest, RangeScanIsOrderedAndHalfOpen) {
+    ts::ordered_map<int, int, std::greater<int>> map;
+    for (int i = 0; i < 1000; ++i) map.insert(i * 7 % 1000, i);
+
+    // With std::greater the order is descending, so [lo, hi) runs from 500 down to 401.
+    std::vector<int> keys;
+    map.for_each_range(500, 400, [&](const int& key, const int&) { keys.push_back(key); });
+    ASSERT_EQ(keys.size(), 100u);
+    EXPECT_EQ(keys.front(), 500);
+    EXPECT_EQ(keys.back(), 401);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end(), std::greater<int>{}));
+}
+
+TEST(TSOrderedMapTest, ConcurrentInsertEraseAndScan) {
+    ts::ordered_map<int, int> map;
+    constexpr int per_thread = 2000;
+    std::atomic<bool> done{false};
+
+    std::thread scanner([&] {
+        while (!done.load()) {
+            int previous = -1;
+            map.for_each_range(0, 1 << 30, [&](const int& key, const int& value) {
+                EXPECT_LT(previous, key);
+                EXPECT_EQ(value, key * 2);
+                previous = key;
+            });
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                int key = i * 4 + t;
+                EXPECT_TRUE(map.insert(key, key * 2));
+                // Keys shared between threads race on insert_or_assign and erase.
+                map.insert_or_assign(i % 64 * 4 + 100000, (i % 64 * 4 + 100000) * 2);
+                if (i % 2 == 1) {
+                    EXPECT_TRUE(map.erase(key));
+                }
+                map.erase(i % 64 * 4 + 100000);
+            }
+        });
+    }
+    for (auto& w : writers) w.join();
+    done = true;
+    scanner.join();
+
+    for (int k = 100000; k < 100256; k += 4) map.erase(k);
+    EXPECT_EQ(map.size(), static_cast<size_t>(4 * per_thread / 2));
+    int count = 0;
+    map.for_each([&](const int& key, const int&) {
+        EXPECT_EQ(key / 4 % 2, 0);
+        ++count;
+    });
+    EXPECT_EQ(count, 4 * per_thread / 2);
+    // Retired nodes and values are freed once every reader has moved on.
+    for (int i = 0; i < 4; ++i) ts::detail::epoch_domain::instance().reclaim();
+}
+
+// --- ts::lru_cache ---
+
+TEST(TSLruCacheTest, BasicOperationsAndStats) {
+    ts::lru_cache<int, std::string> cache(4, 1);
+    EXPECT_EQ(cache.get(1), std::nullopt);
+
+    cache.put(1, "one");
+    cache.put(2, "two");
+    EXPECT_EQ(cache.get(1), "one");
+    EXPECT_TRUE(cache.contains(2));
+    EXPECT_EQ(cache.size(), 2u);
+
+    cache.put(1, "uno");
+    EXPECT_EQ(cache.get(1), "uno");
+    EXPECT_EQ(cache.size(), 2u);
+
+    EXPECT_TRUE(cache.erase(2));
+    EXPECT_FALSE(cache.erase(2));
+    EXPECT_FALSE(cache.contains(2));
+
+    ts::cache_stats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.evictions, 0u);
+    cache.reset_stats();
+    EXPECT_EQ(cache.stats().hits, 0u);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.weight(), 0u);
+}
+
+TEST(TSLruCacheTest, ClockKeepsRecentlyUsedEntries) {
+    ts::lru_cache<int, int> cache(4, 1);
+    for (int i = 0; i < 4; ++i) cache.put(i, i);
+    // 0 and 2 get a second chance; the hand evicts 1 and then 3 first.
+    EXPECT_TRUE(cache.get(0).has_value());
+    EXPECT_TRUE(cache.get(2).has_value());
+
+    cache.put(4, 4);
+    cache.put(5, 5);
+    EXPECT_EQ(cache.size(), 4u);
+    EXPECT_TRUE(cache.contains(0));
+    EXPECT_TRUE(cache.contains(2));
+    EXPECT_FALSE(cache.contains(1));
+    EXPECT_FALSE(cache.contains(3));
+    EXPECT_EQ(cache.stats().evictions, 2u);
+}
+
+TEST(TSLruCacheTest, WeigherBoundsTotalSize) {
+    auto bytes = [](const int&, const std::string& value) { return value.size(); };
+    ts::lru_cache<int, std::string, std::hash<int>, std::equal_to<int>, decltype(bytes)> cache(100, 1, bytes);
+
+    for (int i = 0; i < 50; ++i) {
+        cache.put(i, std::string(static_cast<size_t>(i % 10 + 1), 'x'));
+        EXPECT_LE(cache.weight(), 100u);
+    }
+    EXPECT_GT(cache.stats().evictions, 0u);
+
+    // Heavier than the whole shard: not cached, and the old value under that key is dropped.
+    cache.put(49, std::string(101, 'x'));
+    EXPECT_FALSE(cache.contains(49));
+    EXPECT_LE(cache.weight(), 100u);
+}
+
+TEST(TSLruCacheTest, GetOrLoadRunsLoaderOncePerKey) {
+    ts::lru_cache<int, int> cache(1024);
+    std::atomic<int> loads{0};
+    std::atomic<bool> release{false};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            int value = cache.get_or_load(7, [&] {
+                ++loads;
+                while (!release.load()) std::this_thread::yield();
+                return 49;
+            });
+            EXPECT_EQ(value, 49);
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release = true;
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(loads.load(), 1);
+    EXPECT_EQ(cache.get(7), 49);
+    EXPECT_EQ(cache.get_or_load(7, [] { return 0; }), 49);
+}
+
+TEST(TSLruCacheTest, GetOrLoadPropagatesLoaderException) {
+    ts::lru_cache<int, int> cache(16);
+    EXPECT_THROW(cache.get_or_load(1, []() -> int { throw std::runtime_error("backend down"); }),
+                 std::runtime_error);
+    EXPECT_FALSE(cache.contains(1));
+    // A failed load is not cached; the next caller retries.
+    EXPECT_EQ(cache.get_or_load(1, [] { return 10; }), 10);
+}
+
+TEST(TSLruCacheTest, UnevenCapacitySplitSumsToCapacity) {
+    // 10 over 4 shards splits 3/3/2/2; rounding every shard up would hold 12.
+    ts::lru_cache<int, int> cache(10, 4);
+    EXPECT_EQ(cache.shard_count(), 4u);
+    for (int i = 0; i < 1000; ++i) cache.put(i, i);
+    EXPECT_EQ(cache.size(), 10u);
+
+    ts::lru_cache<int, int> odd(100, 3); // rounded up to 4 shards of 25
+    for (int i = 0; i < 1000; ++i) odd.put(i, i);
+    EXPECT_EQ(odd.size(), 100u);
+
+    // The default shard count rounds down, so every shard keeps at least 8 units.
+    for (size_t capacity : {7u, 8u, 100u, 1000u, 100003u}) {
+        ts::lru_cache<int, int> defaulted(capacity);
+        EXPECT_TRUE(std::has_single_bit(defaulted.shard_count()));
+        EXPECT_TRUE(defaulted.shard_count() == 1 || capacity / defaulted.shard_count() >= 8) << capacity;
+        for (int i = 0; i < 200000; ++i) defaulted.put(i, i);
+        EXPECT_EQ(defaulted.size(), capacity);
+    }
+}
+
+TEST(TSLruCacheTest, ConcurrentMixedWorkloadStaysWithinCapacity) {
+    ts::lru_cache<int, int> cache(256, 8);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(t));
+            for (int i = 0; i < 20000; ++i) {
+                int key = static_cast<int>(rng() % 1024);
+                int value = cache.get_or_load(key, [&] { return key * 3; });
+                EXPECT_EQ(value, key * 3);
+                if (i % 16 == 0) cache.erase(key);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    EXPECT_LE(cache.size(), 256u);
+    ts::cache_stats stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 4u * 20000u);
+}
+
+// --- ts::object_pool ---
+
+TEST(TSObjectPoolTest, RecyclesObjectsWithTheirState) {
+    ts::object_pool<std::vector<int>> pool(4);
+    EXPECT_EQ(pool.live(), 4u);
+    EXPECT_EQ(pool.idle(), 4u);
+
+    std::vector<int>* first = nullptr;
+    {
+        auto buffer = pool.acquire();
+        ASSERT_TRUE(buffer);
+        buffer->assign(100, 7);
+        first = buffer.get();
+    }
+    auto again = pool.acquire();
+    // Released into this thread's cache, so it comes straight back, capacity and contents intact.
+    EXPECT_EQ(again.get(), first);
+    EXPECT_EQ(again->size(), 100u);
+    EXPECT_EQ(pool.live(), 4u);
+
+    auto moved = std::move(again);
+    EXPECT_FALSE(again);
+    EXPECT_EQ(moved.get(), first);
+    moved.reset();
+    EXPECT_FALSE(moved);
+    EXPECT_EQ(moved.get(), nullptr);
+}
+
+TEST(TSObjectPoolTest, GrowsOnDemandAndTrimsUnusedObjects) {
+    ts::object_pool<std::string> pool;
+    {
+        std::vector<ts::object_pool<std::string>::handle> held;
+        for (int i = 0; i < 200; ++i) held.push_back(pool.acquire());
+        EXPECT_EQ(pool.live(), 200u);
+        std::set<std::string*> distinct;
+        for (auto& h : held) distinct.insert(h.get());
+        EXPECT_EQ(distinct.size(), 200u);
+    }
+    // The shared list started empty, so its low-water mark is 0: nothing is surplus yet.
+    EXPECT_EQ(pool.trim(), 0u);
+    size_t idle = pool.idle();
+    EXPECT_GT(idle, 0u);
+    // Nothing was taken since the previous trim(), so every idle object on the shared list goes.
+    EXPECT_EQ(pool.trim(), idle);
+    EXPECT_EQ(pool.idle(), 0u);
+    EXPECT_EQ(pool.live(), 200u - idle);
+
+    auto h = pool.acquire();
+    *h = "reused";
+    EXPECT_EQ(*h, "reused");
+}
+
+TEST(TSObjectPoolTest, ConcurrentAcquireNeverSharesAnObject) {
+    struct tracked {
+        std::atomic<int> owners{0};
+    };
+    ts::object_pool<tracked> pool(8);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 20000; ++i) {
+                std::array<ts::object_pool<tracked>::handle, 3> held;
+                for (auto& h : held) {
+                    h = pool.acquire();
+                    EXPECT_EQ(h->owners.fetch_add(1), 0);
+                }
+                for (auto& h : held) {
+                    h->owners.fetch_sub(1);
+                    h.reset();
+                }
+                if (i % 1000 == 0) pool.trim();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_GE(pool.live(), 1u);
+}
+
+// --- Lock statistics (TS_ENABLE_LOCK_STATS) ---
+
+#ifndef TS_ENABLE_LOCK_STATS
+static_assert(std::is_same_v<ts::detail::instrumented_lock_t<std::mutex>, std::mutex>,
+              "without TS_ENABLE_LOCK_STATS containers must use the bare lock");
+
+TEST(TSLockStatsTest, DisabledByDefault) {
+    ts::vector<int> v{1, 2, 3};
+    v.set_stats_label("unused");
+    EXPECT_EQ(v.stats().acquisitions, 0u);
+    EXPECT_EQ(v.stats().max_hold_site, nullptr);
+}
+#endif
+
+TEST(TSLockStatsTest, CountsContentionWaitAndLongestHold) {
+    ts::detail::stats_lock<std::mutex> lock;
+    lock.set_label("test lock");
+
+    {
+        ts::detail::lock_site site("quick");
+        std::lock_guard guard(lock);
+    }
+
+    std::atomic<bool> held{false};
+    std::thread slow([&] {
+        ts::detail::lock_site site("slow");
+        std::lock_guard guard(lock);
+        held = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+    while (!held.load()) std::this_thread::yield();
+    {
+        std::lock_guard guard(lock);
+    }
+    slow.join();
+
+    ts::lock_stats stats = lock.stats();
+    EXPECT_EQ(stats.acquisitions, 3u);
+    EXPECT_EQ(stats.contended, 1u);
+    EXPECT_GE(stats.max_wait, std::chrono::milliseconds(10));
+    EXPECT_GE(stats.max_hold, std::chrono::milliseconds(20));
+    EXPECT_STREQ(stats.max_hold_site, "slow");
+    EXPECT_EQ(std::accumulate(stats.hold_histogram.begin(), stats.hold_histogram.end(), std::uint64_t{0}), 3u);
+    EXPECT_EQ(stats.hold_histogram[ts::lock_stats::hold_bucket(stats.max_hold)], 1u);
+
+    bool listed = false;
+    for (const auto& entry : ts::lock_registry::instance().snapshot()) {
+        if (entry.lock != nullptr && entry.label == "test lock") {
+            listed = true;
+            EXPECT_EQ(entry.stats.acquisitions, 3u);
+        }
+    }
+    EXPECT_TRUE(listed);
+
+    std::ostringstream dump;
+    ts::lock_registry::instance().dump(dump);
+    EXPECT_NE(dump.str().find("test lock"), std::string::npos);
+    EXPECT_NE(dump.str().find("in slow()"), std::string::npos);
+
+    lock.reset_stats();
+    EXPECT_EQ(lock.stats().acquisitions, 0u);
+}
+
+TEST(TSLockStatsTest, WrapsSharedAndCombiningLocks) {
+    ts::detail::stats_lock<std::shared_mutex> shared;
+    static_assert(ts::detail::shared_lockable<decltype(shared)>);
+    static_assert(!ts::detail::shared_lockable<ts::detail::stats_lock<std::mutex>>);
+    {
+        std::shared_lock first(shared);
+        std::shared_lock second(shared);
+    }
+    EXPECT_EQ(shared.stats().acquisitions, 2u);
+    EXPECT_EQ(shared.stats().total_hold.count(), 0);
+
+    ts::detail::stats_lock<ts::flat_combining_mutex> combining;
+    static_assert(ts::detail::combining_lock<decltype(combining)>);
+    int counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) ts::detail::with_lock(combining, [&] { ++counter; });
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(counter, 4000);
+    EXPECT_EQ(combining.stats().acquisitions, 4000u);
+}
+
+TEST(TSLockStatsTest, RegistryForgetsDestroyedLocks) {
+    size_t before = ts::lock_registry::instance().snapshot().size();
+    {
+        ts::detail::stats_lock<ts::spinlock> lock;
+        EXPECT_EQ(ts::lock_registry::instance().snapshot().size(), before + 1);
+    }
+    EXPECT_EQ(ts::lock_registry::instance().snapshot().size(), before);
+}
+
+#ifdef TS_ENABLE_LOCK_STATS
+TEST(TSLockStatsTest, ContainersRecordTheirOperations) {
+    ts::deque<int> d;
+    d.set_stats_label("jobs");
+    d.push_back(1);
+    d.read([](const std::deque<int>&) { std::this_thread::sleep_for(std::chrono::milliseconds(5)); });
+    EXPECT_EQ(d.pop_front(), 1);
+
+    ts::lock_stats stats = d.stats();
+    EXPECT_EQ(stats.acquisitions, 3u);
+    EXPECT_STREQ(stats.max_hold_site, "read");
+}
+#endif